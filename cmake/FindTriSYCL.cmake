@@ -166,6 +166,7 @@ option(TRISYCL_OPENMP "triSYCL multi-threading with OpenMP" ON)
 option(TRISYCL_TBB "triSYCL multi-threading with TBB" OFF)
 option(TRISYCL_OPENCL "triSYCL OpenCL interoperability mode" OFF)
 option(TRISYCL_NO_ASYNC "triSYCL use synchronous kernel execution" OFF)
+option(TRISYCL_FIBER_BARRIER "triSYCL work-group barriers with fibers" ON)
 option(TRISYCL_DEBUG "triSYCL use debug mode" OFF)
 option(TRISYCL_DEBUG_STRUCTORS "triSYCL trace of object lifetimes" OFF)
 option(TRISYCL_TRACE_KERNEL "triSYCL trace of kernel execution" OFF)
@@ -175,6 +176,7 @@ mark_as_advanced(TRISYCL_OPENMP)
 mark_as_advanced(TRISYCL_TBB)
 mark_as_advanced(TRISYCL_OPENCL)
 mark_as_advanced(TRISYCL_NO_ASYNC)
+mark_as_advanced(TRISYCL_FIBER_BARRIER)
 mark_as_advanced(TRISYCL_DEBUG)
 mark_as_advanced(TRISYCL_DEBUG_STRUCTORS)
 mark_as_advanced(TRISYCL_TRACE_KERNEL)
@@ -224,6 +226,9 @@ set(BOOST_REQUIRED_COMPONENTS chrono log)
 if(TRISYCL_OPENCL)
   list(APPEND BOOST_REQUIRED_COMPONENTS filesystem)
 endif()
+if(TRISYCL_FIBER_BARRIER)
+  list(APPEND BOOST_REQUIRED_COMPONENTS context)
+endif()
 find_package(Boost 1.58 REQUIRED COMPONENTS ${BOOST_REQUIRED_COMPONENTS})
 
 # If debug or trace we need boost log
@@ -238,6 +243,7 @@ message(STATUS "triSYCL OpenMP:                   ${TRISYCL_OPENMP}")
 message(STATUS "triSYCL TBB:                      ${TRISYCL_TBB}")
 message(STATUS "triSYCL OpenCL:                   ${TRISYCL_OPENCL}")
 message(STATUS "triSYCL synchronous execution:    ${TRISYCL_NO_ASYNC}")
+message(STATUS "triSYCL fiber barriers:           ${TRISYCL_FIBER_BARRIER}")
 message(STATUS "triSYCL debug mode:               ${TRISYCL_DEBUG}")
 message(STATUS "triSYCL object trace:             ${TRISYCL_DEBUG_STRUCTORS}")
 message(STATUS "triSYCL kernel trace:             ${TRISYCL_TRACE_KERNEL}")
@@ -267,11 +273,13 @@ function(add_sycl_to_target targetName)
     Threads::Threads
     $<$<BOOL:${LOG_NEEDED}>:Boost::log>
     Boost::chrono
+    $<$<BOOL:${TRISYCL_FIBER_BARRIER}>:Boost::context>
     $<$<BOOL:${TRISYCL_OPENCL}>:Boost::filesystem>) #Required by BOOST_COMPUTE_USE_OFFLINE_CACHE.
 
   # Compile definitions
   target_compile_definitions(${targetName} PUBLIC
     $<$<BOOL:${TRISYCL_NO_ASYNC}>:TRISYCL_NO_ASYNC>
+    $<$<BOOL:${TRISYCL_FIBER_BARRIER}>:TRISYCL_FIBER_BARRIER>
     $<$<BOOL:${TRISYCL_OPENCL}>:TRISYCL_OPENCL>
     $<$<BOOL:${TRISYCL_OPENCL}>:BOOST_COMPUTE_USE_OFFLINE_CACHE>
     $<$<BOOL:${TRISYCL_DEBUG}>:TRISYCL_DEBUG>
@@ -133,6 +133,11 @@ class accessor :
       offset+range[ for every dimension. Any other parts of the buffer
       will be unaffected.
 
+      The accessor is indexed relatively to the offset. The kernel only
+      depends on the kernels accessing an overlapping part of the
+      buffer, and with OpenCL only this part is transferred to the
+      device when reading it.
+
       Constructor only available for access modes global_buffer, and
       constant_buffer (see Table "Buffer accessor constructors").
       access_target defines the form of access being obtained.
@@ -140,13 +145,50 @@ class accessor :
       This accessor is recommended for discard-write and discard read
       write access modes, when the unaffected parts of the processing
       should be retained.
+
+      \throw invalid_object_error if the accessed part exceeds the
+      buffer
   */
   template <typename Allocator>
   accessor(buffer<DataType, Dimensions, Allocator> &target_buffer,
            handler &command_group_handler,
-           const range<Dimensions> &offset,
-           const range<Dimensions> &range) {
-    TRISYCL_UNIMPL;
+           const range<Dimensions> &access_range,
+           const id<Dimensions> &access_offset = {}) : implementation_t {
+    new detail::accessor<DataType, Dimensions, AccessMode, Target> {
+      target_buffer.implementation->implementation,
+      command_group_handler,
+      access_range,
+      access_offset }
+  } {
+    static_assert(Target == access::target::global_buffer
+                  || Target == access::target::constant_buffer,
+                  "access target should be global_buffer or constant_buffer "
+                  "when a handler is used");
+    // Now the implementation is created, register it
+    implementation->register_accessor();
+  }
+
+
+  /** Construct a host accessor to the part of a buffer of size
+      access_range starting at access_offset
+
+      The accessor is indexed relatively to the offset.
+
+      \throw invalid_object_error if the accessed part exceeds the
+      buffer
+  */
+  template <typename Allocator>
+  accessor(buffer<DataType, Dimensions, Allocator> &target_buffer,
+           const range<Dimensions> &access_range,
+           const id<Dimensions> &access_offset = {})
+    : implementation_t {
+    new detail::accessor<DataType, Dimensions, AccessMode, Target> {
+      target_buffer.implementation->implementation,
+      access_range,
+      access_offset }
+  } {
+    static_assert(Target == access::target::host_buffer,
+                  "without a handler, access target should be host_buffer");
   }
 
 
@@ -194,6 +236,12 @@ class accessor :
   }
 
 
+  /// Return the origin of the accessed part of the buffer
+  auto get_offset() const {
+    return implementation->get_offset();
+  }
+
+
   /** Returns the total number of elements behind the accessor
 
       Equal to get_range()[0] * ... * get_range()[Dimensions-1].
@@ -20,6 +20,7 @@
 #include "triSYCL/access.hpp"
 #include "triSYCL/command_group/detail/task.hpp"
 #include "triSYCL/detail/debug.hpp"
+#include "triSYCL/detail/local_memory_slot.hpp"
 #include "triSYCL/id.hpp"
 #include "triSYCL/item.hpp"
 #include "triSYCL/nd_item.hpp"
@@ -80,6 +81,28 @@ class accessor<T, Dimensions, Mode, access::target::local> :
   */
   mutable T *allocation = nullptr;
 
+  /// The local memory of another work-group executed concurrently
+  struct slot {
+    T *allocation;
+    writable_array_type array;
+
+    slot(const range<Dimensions> &r)
+      : allocation { std::allocator<T>{}.allocate(r.size()) }
+      , array { allocation, r } {}
+
+    ~slot() {
+      std::allocator<T>{}.deallocate(allocation, array.num_elements());
+    }
+  };
+
+  /** The local memory of each local memory slot but the first one,
+      which is the main allocation
+
+      An element is only accessed by the thread executing a work-group
+      with this slot, so it can be allocated lazily without locking.
+  */
+  mutable std::unique_ptr<std::unique_ptr<slot>[]> slots;
+
 public:
 
   /** \todo in the specification: store the dimension for user request
@@ -113,7 +136,8 @@ public:
   */
   accessor(const range<Dimensions> &allocation_size,
            handler &command_group_handler) :
-    array { allocate_accessor(allocation_size) } {}
+    array { allocate_accessor(allocation_size) },
+    slots { new std::unique_ptr<slot>[max_local_memory_slots] } {}
 
 
   // Deallocate the memory
@@ -174,7 +198,7 @@ public:
       work in some dimensions.
    */
   reference operator[](std::size_t index) {
-    return array[index];
+    return local_array()[index];
   }
 
 
@@ -184,19 +208,19 @@ public:
       work in some dimensions.
    */
   reference operator[](std::size_t index) const {
-    return array[index];
+    return local_array()[index];
   }
 
 
   /// To use the accessor with [id<>]
   auto &operator[](id<dimensionality> index) {
-    return array(index);
+    return local_array()(index);
   }
 
 
   /// To use the accessor with [id<>]
   auto &operator[](id<dimensionality> index) const {
-    return array(index);
+    return local_array()(index);
   }
 
 
@@ -236,7 +260,7 @@ public:
       \todo Add in the specification
   */
   reference operator*() {
-    return *array.data();
+    return *local_array().data();
   }
 
 
@@ -251,7 +275,7 @@ public:
       the value with the accessor?
   */
   reference operator*() const {
-    return *array.data();
+    return *local_array().data();
   }
 
 
@@ -312,13 +336,13 @@ public:
 
   // iterator begin() { return array.begin(); }
   iterator begin() const {
-    return const_cast<writable_array_type &>(array).begin();
+    return local_array().begin();
   }
 
 
   // iterator end() { return array.end(); }
   iterator end() const {
-    return const_cast<writable_array_type &>(array).end();
+    return local_array().end();
   }
 
 
@@ -328,21 +352,21 @@ public:
   // const_iterator end() const { return array.end(); }
 
 
-  const_iterator cbegin() const { return array.begin(); }
+  const_iterator cbegin() const { return local_array().begin(); }
 
 
-  const_iterator cend() const { return array.end(); }
+  const_iterator cend() const { return local_array().end(); }
 
 
   // reverse_iterator rbegin() { return array.rbegin(); }
   reverse_iterator rbegin() const {
-    return const_cast<writable_array_type &>(array).rbegin();
+    return local_array().rbegin();
   }
 
 
   // reverse_iterator rend() { return array.rend(); }
   reverse_iterator rend() const {
-    return const_cast<writable_array_type &>(array).rend();
+    return local_array().rend();
   }
 
 
@@ -352,13 +376,26 @@ public:
   // const_reverse_iterator rend() const { return array.rend(); }
 
 
-  const_reverse_iterator crbegin() const { return array.rbegin(); }
+  const_reverse_iterator crbegin() const { return local_array().rbegin(); }
 
 
-  const_reverse_iterator crend() const { return array.rend(); }
+  const_reverse_iterator crend() const { return local_array().rend(); }
 
 private:
 
+  /** Get the local memory of the work-group executed by the current
+      thread */
+  writable_array_type &local_array() const {
+    const auto s = local_memory_slot;
+    if (s == 0)
+      return array;
+    auto &p = slots[s];
+    if (!p)
+      p = std::make_unique<slot>(get_range());
+    return p->array;
+  }
+
+
   /// Allocate uninitialized buffer memory
   auto allocate_accessor(const range<Dimensions> &r) {
     auto count = r.size();
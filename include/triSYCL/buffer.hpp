@@ -24,6 +24,7 @@
 #include "triSYCL/event.hpp"
 #include "triSYCL/handler.hpp"
 #include "triSYCL/id.hpp"
+#include "triSYCL/mapped_file.hpp"
 #include "triSYCL/queue.hpp"
 #include "triSYCL/range.hpp"
 
@@ -36,11 +37,13 @@ namespace trisycl {
 /** A SYCL buffer is a multidimensional variable length array (à la C99
     VLA or even Fortran before) that is used to store data to work on.
 
+    The allocator is used for the memory allocated by the runtime,
+    which is all the memory of the buffer except the host memory
+    provided by the user.
+
     \todo There is a naming inconsistency in the specification between
     buffer and accessor on T versus datatype
 
-    \todo Finish allocator implementation
-
     \todo Think about the need of an allocator when constructing a buffer
     from other buffers
 
@@ -111,7 +114,7 @@ public:
   */
   buffer(const range<Dimensions> &r, Allocator allocator = {})
     : implementation_t { detail::waiter<T, Dimensions, Allocator>(
-                         new detail::buffer<T, Dimensions> { r }) }
+                         new detail::buffer<T, Dimensions> { r, allocator }) }
       {}
 
 
@@ -145,8 +148,9 @@ public:
   buffer(const T *host_data,
          const range<Dimensions> &r,
          Allocator allocator = {})
-    : implementation_t { detail::waiter(new detail::buffer<T, Dimensions>
-                         { host_data, r }) }
+    : implementation_t { detail::waiter<T, Dimensions, Allocator>(
+                         new detail::buffer<T, Dimensions>
+                         { host_data, r, allocator }) }
   {}
 
 
@@ -169,7 +173,8 @@ public:
   buffer(T *host_data,
          const range<Dimensions> &r,
          Allocator allocator = {})
-    : implementation_t { detail::waiter(new detail::buffer<T, Dimensions>
+    : implementation_t { detail::waiter<T, Dimensions, Allocator>(
+                         new detail::buffer<T, Dimensions>
                          { host_data, r }) }
   {}
 
@@ -226,7 +231,8 @@ public:
   buffer(shared_ptr_class<T> host_data,
          const range<Dimensions> &buffer_range,
          Allocator allocator = {})
-    : implementation_t { detail::waiter(new detail::buffer<T, Dimensions>
+    : implementation_t { detail::waiter<T, Dimensions, Allocator>(
+                         new detail::buffer<T, Dimensions>
                          { host_data, buffer_range }) }
   {}
 
@@ -271,8 +277,32 @@ public:
   buffer(InputIterator start_iterator,
          InputIterator end_iterator,
          Allocator allocator = {}) :
-    implementation_t { detail::waiter(new detail::buffer<T, Dimensions>
-                       { start_iterator, end_iterator }) }
+    implementation_t { detail::waiter<T, Dimensions, Allocator>(
+                       new detail::buffer<T, Dimensions>
+                       { start_iterator, end_iterator, allocator }) }
+  {}
+
+
+  /** Create a new buffer using a file mapped in memory as storage
+
+      \param[in] file describes the file, the position of the data in
+      the file and how it is mapped
+
+      \param[in] r defines the size
+
+      The pages of the file are loaded only when accessed, so the
+      buffer can be larger than the memory. With
+      mapped_file::mode::read_write_shared the modifications are
+      written back to the file on buffer destruction with only a
+      synchronization of the mapping.
+
+      \throw runtime_error if the file cannot be mapped
+
+      This is a triSYCL extension.
+  */
+  buffer(const mapped_file &file, const range<Dimensions> &r)
+    : implementation_t { detail::waiter<T, Dimensions, Allocator>(
+                         new detail::buffer<T, Dimensions> { file, r }) }
   {}
 
 
@@ -286,14 +316,25 @@ public:
 
       \param[in] sub_range specifies the size of the sub-buffer
 
-      \todo To be implemented
+      The sub-buffer shares the memory of b, so there is no copy. The
+      kernels accessing disjoint sub-buffers of the same buffer do not
+      depend on each other and can run concurrently.
+
+      \throw invalid_object_error if the sub-buffer exceeds b or is not
+      a contiguous region of b
 
       \todo Update the specification to replace index by id
   */
   buffer(buffer<T, Dimensions, Allocator> &b,
          const id<Dimensions> &base_index,
          const range<Dimensions> &sub_range,
-         Allocator allocator = {}) { TRISYCL_UNIMPL; }
+         Allocator allocator = {})
+    : implementation_t { detail::waiter<T, Dimensions, Allocator>(
+                         new detail::buffer<T, Dimensions>
+                         { b.implementation->implementation,
+                           base_index,
+                           sub_range }) }
+  {}
 
 
 #ifdef TRISYCL_OPENCL
@@ -349,11 +390,32 @@ public:
                   "get_access(handler) can only deal with access::global_buffer"
                   " or access::constant_buffer (for host_buffer accessor"
                   " do not use a command group handler");
-    implementation->implementation->template track_access_mode<Mode, Target>();
     return { *this, command_group_handler };
   }
 
 
+  /** Get an accessor to the part of the buffer of size \param
+      access_range starting at \param access_offset
+
+      The accessor is indexed relatively to the offset and the kernel
+      only depends on the kernels accessing an overlapping part of the
+      buffer.
+  */
+  template <access::mode Mode,
+            access::target Target = access::target::global_buffer>
+  accessor<T, Dimensions, Mode, Target>
+  get_access(handler &command_group_handler,
+             const range<Dimensions> &access_range,
+             const id<Dimensions> &access_offset = {}) {
+    static_assert(Target == access::target::global_buffer
+                  || Target == access::target::constant_buffer,
+                  "get_access(handler) can only deal with access::global_buffer"
+                  " or access::constant_buffer (for host_buffer accessor"
+                  " do not use a command group handler");
+    return { *this, command_group_handler, access_range, access_offset };
+  }
+
+
   /** Force the buffer to behave like if we had created
       an accessor in write mode.
    */
@@ -373,11 +435,23 @@ public:
   template <access::mode Mode>
   accessor<T, Dimensions, Mode, access::target::host_buffer>
   get_access() {
-    implementation->implementation->template track_access_mode<Mode, access::target::host_buffer>();
     return { *this };
   }
 
 
+  /** Get a host accessor to the part of the buffer of size \param
+      access_range starting at \param access_offset
+
+      The accessor is indexed relatively to the offset.
+  */
+  template <access::mode Mode>
+  accessor<T, Dimensions, Mode, access::target::host_buffer>
+  get_access(const range<Dimensions> &access_range,
+             const id<Dimensions> &access_offset = {}) {
+    return { *this, access_range, access_offset };
+  }
+
+
   /** Return a range object representing the size of the buffer in
       terms of number of elements in each dimension as passed to the
       constructor
@@ -435,6 +509,12 @@ public:
   }
 
 
+  /// Test if this buffer is a sub-buffer of another one
+  bool is_sub_buffer() const {
+    return implementation->implementation->is_sub_buffer();
+  }
+
+
   /** Ask for read-only status of the buffer
 
       \todo Add to specification
@@ -15,15 +15,18 @@
 #ifdef TRISYCL_OPENCL
 #include <boost/compute.hpp>
 #endif
+#include <boost/array.hpp>
 #include <boost/multi_array.hpp>
 
 #include "triSYCL/access.hpp"
 #include "triSYCL/accessor/detail/accessor_base.hpp"
 #include "triSYCL/command_group/detail/task.hpp"
 #include "triSYCL/detail/debug.hpp"
+#include "triSYCL/exception.hpp"
 #include "triSYCL/id.hpp"
 #include "triSYCL/item.hpp"
 #include "triSYCL/nd_item.hpp"
+#include "triSYCL/range.hpp"
 
 namespace trisycl {
 
@@ -80,12 +83,26 @@ class accessor :
   using writable_array_view_type =
     typename std::remove_const<array_view_type>::type;
 
+  /// The part of the buffer accessed, the whole buffer by default
+  range<Dimensions> access_range;
+
+  /// The origin of the part of the buffer accessed
+  id<Dimensions> access_offset;
+
+  /** The smallest linear range of elements of the buffer containing
+      the accessed part, which is what the dependencies and the data
+      transfers are about */
+  std::size_t window_begin;
+  std::size_t window_end;
+
   /** The way the buffer is really accessed
 
       Use a mutable member because the accessor needs to be captured
       by value in the lambda which is then read-only. This is to avoid
       the user to use mutable lambda or have a lot of const_cast as
       previously done in this implementation
+
+      It is declared after the window which is computed first.
    */
   mutable array_view_type array;
 
@@ -121,8 +138,22 @@ public:
       template parm
   */
   accessor(std::shared_ptr<detail::buffer<T, Dimensions>> target_buffer) :
-    buf { target_buffer }, array { target_buffer->access } {
-    target_buffer->template track_access_mode<Mode>();
+    accessor { target_buffer, target_buffer->get_range(), {} } {}
+
+
+  /** Construct a host accessor to the part of an existing buffer of
+      size \param access_range starting at \param access_offset
+
+      The accessor is indexed relatively to \param access_offset
+  */
+  accessor(std::shared_ptr<detail::buffer<T, Dimensions>> target_buffer,
+           const range<Dimensions> &access_range,
+           const id<Dimensions> &access_offset) :
+    buf { target_buffer },
+    access_range { access_range },
+    access_offset { access_offset },
+    array { window_storage() } {
+    set_origin();
     TRISYCL_DUMP_T("Create a host accessor write = " << is_write_access());
     static_assert(Target == access::target::host_buffer,
                   "without a handler, access target should be host_buffer");
@@ -137,7 +168,7 @@ public:
        host accessors are blocking
      */
     trisycl::context ctx;
-    buf->update_buffer_state(ctx, Mode, get_size(), array.data());
+    update_buffer_state(ctx);
 #endif
   }
 
@@ -149,15 +180,37 @@ public:
   */
   accessor(std::shared_ptr<detail::buffer<T, Dimensions>> target_buffer,
            handler &command_group_handler) :
-    buf { target_buffer }, array { target_buffer->access } {
-    target_buffer->template track_access_mode<Mode>();
+    accessor { target_buffer, command_group_handler,
+               target_buffer->get_range(), {} } {}
+
+
+  /** Construct a device accessor to the part of an existing buffer of
+      size \param access_range starting at \param access_offset
+
+      The accessor is indexed relatively to \param access_offset and
+      the kernel only depends on the kernels accessing an overlapping
+      part of the buffer.
+  */
+  accessor(std::shared_ptr<detail::buffer<T, Dimensions>> target_buffer,
+           handler &command_group_handler,
+           const range<Dimensions> &access_range,
+           const id<Dimensions> &access_offset) :
+    buf { target_buffer },
+    access_range { access_range },
+    access_offset { access_offset },
+    array { window_storage() } {
+    set_origin();
     TRISYCL_DUMP_T("Create a kernel accessor write = " << is_write_access());
     static_assert(Target == access::target::global_buffer
                   || Target == access::target::constant_buffer,
                   "access target should be global_buffer or constant_buffer "
                   "when a handler is used");
     // Register the buffer to the task dependencies
-    task = buffer_add_to_task(buf, &command_group_handler, is_write_access());
+    task = buffer_add_to_task(buf,
+                              &command_group_handler,
+                              is_write_access(),
+                              window_begin,
+                              window_end);
   }
 
 
@@ -204,16 +257,13 @@ public:
       https://cvs.khronos.org/bugzilla/show_bug.cgi?id=14404
   */
   auto get_range() const {
-    /* Interpret the shape which is a pointer to the first element as an
-       array of Dimensions elements so that the range<Dimensions>
-       constructor is happy with this collection
+    return access_range;
+  }
 
-       \todo Add also a constructor in range<> to accept a const
-       std::size_t *?
-    */
-    return range<Dimensions> {
-      *(const std::size_t (*)[Dimensions])(array.shape())
-        };
+
+  /// Return the origin of the accessed part of the buffer
+  auto get_offset() const {
+    return access_offset;
   }
 
 
@@ -226,7 +276,7 @@ public:
       https://cvs.khronos.org/bugzilla/show_bug.cgi?id=14404
   */
   auto get_count() const {
-    return array.num_elements();
+    return access_range.size();
   }
 
 
@@ -367,6 +417,8 @@ public:
 
   /** Return the pointer to the data
 
+      This is the start of the buffer, even with an access offset.
+
       \todo Implement the various pointer address spaces
   */
   auto
@@ -448,6 +500,42 @@ public:
 
 private:
 
+  /** Check the accessed part is inside the buffer and compute its
+      linear window
+
+      \return the storage of the buffer to access, with at least the
+      window up to date
+
+      \throw invalid_object_error if the accessed part exceeds the
+      buffer
+  */
+  auto &window_storage() {
+    auto r = buf->get_range();
+    window_begin = 0;
+    window_end = 0;
+    for (int d = 0; d != Dimensions; ++d) {
+      if (access_offset[d] + access_range[d] > r[d])
+        throw invalid_object_error("The accessor exceeds the buffer");
+      window_begin = window_begin*r[d] + access_offset[d];
+      // The linear position of the last element accessed
+      window_end = window_end*r[d] + access_offset[d] + access_range[d] - 1;
+    }
+    window_end = access_range.size() ? window_end + 1 : window_begin;
+    // Only the window of the storage has to be up to date
+    return buf->template access_for<Mode>(window_begin, window_end);
+  }
+
+
+  /// Shift the indexing by the access offset
+  void set_origin() {
+    // The indices of the accessor are relative to the offset
+    boost::array<typename array_view_type::index, Dimensions> bases;
+    for (int d = 0; d != Dimensions; ++d)
+      bases[d] = -static_cast<typename array_view_type::index>
+        (access_offset[d]);
+    array.reindex(bases);
+  }
+
 #ifdef TRISYCL_OPENCL
   // The following function are used from handler
   friend handler;
@@ -468,7 +556,15 @@ private:
        the buffer doesn't already exists or if the data is not up to date
     */
     auto ctx = task->get_queue()->get_context();
-    buf->update_buffer_state(ctx, Mode, get_size(), array.data());
+    update_buffer_state(ctx);
+  }
+
+
+  /// Update the state of the buffer for an access to the window
+  void update_buffer_state(const trisycl::context &ctx) {
+    buf->update_buffer_state(ctx, Mode, buf->get_size(), array.data(),
+                             window_begin*sizeof(value_type),
+                             window_end*sizeof(value_type));
   }
 
 
@@ -9,8 +9,12 @@
     License. See LICENSE.TXT for details.
 */
 
+#include <algorithm>
 #include <cstddef>
+#include <functional>
+#include <limits>
 #include <memory>
+#include <new>
 #include <type_traits>
 
 #include <boost/multi_array.hpp>
@@ -21,6 +25,10 @@
 #include "triSYCL/buffer/detail/accessor.hpp"
 #include "triSYCL/buffer/detail/buffer_base.hpp"
 #include "triSYCL/buffer/detail/buffer_waiter.hpp"
+#include "triSYCL/buffer/detail/file_mapping.hpp"
+#include "triSYCL/buffer/detail/lazy_copy.hpp"
+#include "triSYCL/exception.hpp"
+#include "triSYCL/id.hpp"
 #include "triSYCL/range.hpp"
 
 namespace trisycl::detail {
@@ -62,25 +70,39 @@ private:
 
   /** The allocator to be used when some memory is needed
 
-      \todo Implement user-provided allocator
+      It is type-erased so that the buffer implementation, and thus the
+      accessors, do not depend on the allocator type.
   */
-  std::allocator<non_const_value_type> alloc;
+  std::function<non_const_value_type *(std::size_t)> allocate =
+    allocate_with(std::allocator<non_const_value_type> {});
 
-  /** This is the multi-dimensional interface to the data that may point
-      to either allocation in the case of storage managed by SYCL itself
-      or to some other memory location in the case of host memory or
-      storage<> abstraction use
-  */
-  boost::multi_array_ref<value_type, Dimensions> access;
+  /// Give back some memory to the allocator
+  std::function<void(non_const_value_type *, std::size_t)> deallocate =
+    deallocate_with(std::allocator<non_const_value_type> {});
 
   /** If some allocation is requested on the host for the buffer
       memory, this is where the memory is attached to.
 
       Note that this is uninitialized memory, as stated in SYCL
       specification.
+
+      It is declared before access which is initialized with it.
   */
   non_const_value_type *allocation = nullptr;
 
+  /// The file mapped as storage of the buffer, if any
+  std::unique_ptr<file_mapping> mapping;
+
+  /// The copy on write still in progress, if any
+  std::unique_ptr<lazy_copy> pending_copy;
+
+  /** This is the multi-dimensional interface to the data that may point
+      to either allocation in the case of storage managed by SYCL itself
+      or to some other memory location in the case of host memory or
+      storage<> abstraction use
+  */
+  boost::multi_array_ref<value_type, Dimensions> access;
+
   /* How to copy back data on buffer destruction, can be modified with
      set_final_data( ... )
    */
@@ -103,8 +125,31 @@ private:
 
 public:
 
-  /// Create a new read-write buffer of size \param r
-  buffer(const range<Dimensions> &r) : access { allocate_buffer(r) } {}
+  /** Create a new read-write buffer of size \param r with memory
+      from \param allocator */
+  template <typename Allocator = std::allocator<non_const_value_type>>
+  buffer(const range<Dimensions> &r, const Allocator &allocator = {}) :
+    allocate { allocate_with(allocator) },
+    deallocate { deallocate_with(allocator) },
+    access { allocate_buffer(r) } {}
+
+
+  /** Create a new buffer of size \param r using the file described
+      by \param file as storage
+
+      With a shared mapping, the write-back on destruction only
+      synchronizes the file. A read-only mapping is copied on the first
+      write, as the const host data.
+  */
+  buffer(const mapped_file &file, const range<Dimensions> &r) :
+    mapping { new file_mapping { file, r.size()*sizeof(value_type) } },
+    access { static_cast<value_type *>(mapping->get_data()), r },
+    data_host { true },
+    copy_if_modified { file.get_mode() == mapped_file::mode::read_only }
+  {
+    if (file.get_mode() == mapped_file::mode::read_write_shared)
+      final_write_back = [this] { mapping->sync(); };
+  }
 
 
   /** Create a new read-write buffer from \param host_data of size
@@ -126,10 +171,17 @@ public:
 
       Only enable this constructor if the value type is not constant,
       because if it is constant, the buffer is constant too.
+
+      The copy is allocated with \param allocator.
   */
-  template <typename Dependent = T,
+  template <typename Allocator = std::allocator<non_const_value_type>,
+            typename Dependent = T,
             typename = std::enable_if_t<!std::is_const<Dependent>::value>>
-  buffer(const T *host_data, const range<Dimensions> &r) :
+  buffer(const T *host_data,
+         const range<Dimensions> &r,
+         const Allocator &allocator = {}) :
+    allocate { allocate_with(allocator) },
+    deallocate { deallocate_with(allocator) },
     /* The buffer is read-only, even if the internal multidimensional
        wrapper is not. If a write accessor is requested, there should
        be a copy on write. So this pointer should not be written and
@@ -157,9 +209,15 @@ public:
   {}
 
 
-  /// Create a new allocated 1D buffer from the given elements
-  template <typename Iterator>
-  buffer(Iterator start_iterator, Iterator end_iterator) :
+  /** Create a new allocated 1D buffer from the given elements, with
+      memory from \param allocator */
+  template <typename Iterator,
+            typename Allocator = std::allocator<non_const_value_type>>
+  buffer(Iterator start_iterator,
+         Iterator end_iterator,
+         const Allocator &allocator = {}) :
+    allocate { allocate_with(allocator) },
+    deallocate { deallocate_with(allocator) },
     access { allocate_buffer(std::distance(start_iterator, end_iterator)) }
     {
       /* Then assign allocation since this is the only multi_array
@@ -171,11 +229,26 @@ public:
   /** Create a new sub-buffer without allocation to have separate
       accessors later
 
-      \todo To implement and deal with reference counting
-  buffer(buffer<T, Dimensions> b,
-         index<Dimensions> base_index,
-         range<Dimensions> sub_range)
+      The sub-buffer aliases the region of \param b starting at \param
+      base_index of size \param sub_range and keeps the root buffer
+      alive. The region has to be contiguous, so only the first
+      dimension with more than 1 element can be cut, the following
+      ones being complete.
+
+      \throw invalid_object_error if the region is outside of the
+      buffer or is not contiguous
   */
+  buffer(const std::shared_ptr<buffer> &b,
+         const id<Dimensions> &base_index,
+         const range<Dimensions> &sub_range) :
+    access { b->access.data() + b->sub_buffer_offset(base_index, sub_range),
+             sub_range }
+  {
+    region_begin = b->region_begin + (access.data() - b->access.data());
+    region_end = region_begin + sub_range.size();
+    // The sub-buffers of a sub-buffer share the same root
+    parent = b->parent ? b->parent : b;
+  }
 
   /// \todo Allow CLHPP objects too?
   ///
@@ -200,8 +273,12 @@ public:
     call_update_buffer_state(host_context, access::mode::read, size, access.data());
 
 #endif
-    if (modified && final_write_back)
+    if (modified && final_write_back) {
+      // The write-back needs the whole content
+      if (pending_copy)
+        pending_copy->copy(0, get_size(), false);
       (*final_write_back)();
+    }
     // Allocate explicitly allocated memory if required
     deallocate_buffer();
   }
@@ -212,6 +289,14 @@ public:
    */
   void mark_as_written() {
     modified = true;
+    if (parent)
+      root_buffer()->mark_as_written();
+  }
+
+
+  /// Test if this buffer is a sub-buffer of another one
+  bool is_sub_buffer() const {
+    return static_cast<bool>(parent);
   }
 
 
@@ -219,10 +304,28 @@ public:
 
       Its current purpose is to track if an accessor with write access
       is created and acting accordingly.
+
+      The accessor uses the elements [\param begin, \param end) in
+      the linear order, the whole buffer by default.
+
+      On a copy on write, the pages of this window not copied yet are
+      copied right now, even if the kernel does not use all of them:
+      see lazy_copy.
    */
   template <access::mode Mode,
             access::target Target = access::target::host_buffer>
-  void track_access_mode() {
+  void track_access_mode(std::size_t begin = 0,
+                         std::size_t end =
+                         std::numeric_limits<std::size_t>::max()) {
+    end = std::min(end, get_count());
+    if (parent) {
+      // Writing through a sub-buffer modifies the root buffer
+      auto root = root_buffer();
+      root->template track_access_mode<Mode, Target>(region_begin + begin,
+                                                     region_begin + end);
+      // Follow the root storage, which may have been copied on write
+      set_access(root->access.data() + region_begin);
+    }
     // test if write access is required
     if (   Mode == access::mode::write
         || Mode == access::mode::read_write
@@ -235,22 +338,35 @@ public:
         // Implement the allocate & copy-on-write optimization
         copy_if_modified = false;
         data_host = false;
-        // Since \c allocate_buffer() changes \c access, keep a copy first
-        auto current_access = access;
-        /* The range is actually computed from \c access itself, so
-           save it */
-        auto current_range = get_range();
-        allocate_buffer(current_range);
-        /* Then move everything to the new place
-
-           \todo Use std::uninitialized_move instead, when we switch
-           to full C++17
-        */
-        std::copy(current_access.begin(),
-                  current_access.end(),
-                  access.begin());
+        auto source = access.data();
+        allocate_buffer(get_range());
+        /* Copy the pages only when they are accessed, if a copy of
+           the bytes is a valid copy */
+        if constexpr (std::is_trivially_copyable_v<non_const_value_type>)
+          pending_copy.reset(new lazy_copy { source, allocation, get_size() });
+        else
+          std::uninitialized_copy_n(source, get_count(), allocation);
+        set_access(allocation);
       }
     }
+    if (pending_copy) {
+      // The previous content is not needed for the discarding modes
+      constexpr bool discard = Mode == access::mode::discard_write
+        || Mode == access::mode::discard_read_write;
+      pending_copy->copy(begin*sizeof(value_type),
+                         end*sizeof(value_type),
+                         discard);
+    }
+  }
+
+
+  /** Track the access mode of a new accessor using the elements
+      [\param begin, \param end) and get the storage it has to use,
+      which may have been copied on write */
+  template <access::mode Mode>
+  auto &access_for(std::size_t begin, std::size_t end) {
+    track_access_mode<Mode>(begin, end);
+    return access;
   }
 
 
@@ -332,19 +448,78 @@ public:
 
 private:
 
+  /// The root buffer of a sub-buffer
+  auto root_buffer() {
+    return std::static_pointer_cast<buffer>(parent);
+  }
+
+
+  /** Compute the linear position of a sub-buffer region, checking it
+      is inside this buffer and contiguous */
+  std::size_t sub_buffer_offset(const id<Dimensions> &base_index,
+                                const range<Dimensions> &sub_range) const {
+    auto r = get_range();
+    std::size_t offset = 0;
+    // Set once a dimension is cut to more than 1 element
+    bool cut = false;
+    for (int d = 0; d != Dimensions; ++d) {
+      if (base_index[d] + sub_range[d] > r[d])
+        throw invalid_object_error("The sub-buffer exceeds the buffer");
+      if (cut && sub_range[d] != r[d])
+        throw invalid_object_error("The sub-buffer is not contiguous");
+      cut = cut || sub_range[d] != 1;
+      offset = offset*r[d] + base_index[d];
+    }
+    return offset;
+  }
+
+
+  /// The allocation function of an allocator, rebound to the buffer type
+  template <typename Allocator>
+  static auto allocate_with(const Allocator &allocator) {
+    using allocator_type = typename std::allocator_traits<Allocator>
+      ::template rebind_alloc<non_const_value_type>;
+    return [a = allocator_type { allocator }] (std::size_t n) mutable {
+      return std::allocator_traits<allocator_type>::allocate(a, n);
+    };
+  }
+
+
+  /// The deallocation function of an allocator, rebound to the buffer type
+  template <typename Allocator>
+  static auto deallocate_with(const Allocator &allocator) {
+    using allocator_type = typename std::allocator_traits<Allocator>
+      ::template rebind_alloc<non_const_value_type>;
+    return [a = allocator_type { allocator }]
+      (non_const_value_type *p, std::size_t n) mutable {
+      std::allocator_traits<allocator_type>::deallocate(a, p, n);
+    };
+  }
+
+
   /// Allocate uninitialized buffer memory
   auto allocate_buffer(const range<Dimensions> &r) {
     auto count = r.size();
     // Allocate uninitialized memory
-    allocation = alloc.allocate(count);
+    allocation = allocate(count);
     return boost::multi_array_ref<value_type, Dimensions> { allocation, r };
   }
 
 
+  /// Make \c access point to \param data with the same shape
+  void set_access(value_type *data) {
+    using access_type = boost::multi_array_ref<value_type, Dimensions>;
+    auto r = get_range();
+    // A multi_array_ref cannot be rebound, only recreated
+    access.~access_type();
+    new (&access) access_type { data, r };
+  }
+
+
   /// Deallocate buffer memory if required
   void deallocate_buffer() {
     if (allocation)
-      alloc.deallocate(allocation, access.num_elements());
+      deallocate(allocation, access.num_elements());
   }
 
 
@@ -428,8 +603,10 @@ template <typename BufferDetail>
 static std::shared_ptr<detail::task>
 buffer_add_to_task(BufferDetail buf,
                    handler *command_group_handler,
-                   bool is_write_mode) {
-    return buf->add_to_task(command_group_handler, is_write_mode);
+                   bool is_write_mode,
+                   std::size_t begin,
+                   std::size_t end) {
+    return buf->add_to_task(command_group_handler, is_write_mode, begin, end);
   }
 
 /// @} End the data Doxygen group
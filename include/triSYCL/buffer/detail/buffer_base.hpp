@@ -10,6 +10,7 @@
     License. See LICENSE.TXT for details.
 */
 
+#include <algorithm>
 #include <atomic>
 #ifdef TRISYCL_OPENCL
 #include <boost/compute.hpp>
@@ -17,11 +18,14 @@
 // \todo Use C++17 optional when it is mainstream
 #include <boost/optional.hpp>
 #include <condition_variable>
+#include <cstddef>
 #include <future>
+#include <limits>
 #include <memory>
 #include <mutex>
 #include <unordered_set>
 #include <utility>
+#include <vector>
 
 #include "triSYCL/command_group/detail/task.hpp"
 #include "triSYCL/context.hpp"
@@ -42,7 +46,9 @@ struct buffer_base;
 inline static std::shared_ptr<detail::task>
 add_buffer_to_task(handler *command_group_handler,
                    std::shared_ptr<detail::buffer_base> b,
-                   bool is_write_mode);
+                   bool is_write_mode,
+                   std::size_t begin,
+                   std::size_t end);
 
 /** Factorize some template independent buffer aspects in a base class
  */
@@ -51,10 +57,42 @@ struct buffer_base : public std::enable_shared_from_this<buffer_base> {
   //// Keep track of the number of kernel accessors using this buffer
   std::atomic<size_t> number_of_users;
 
-  /// Track the latest task to produce this buffer
-  std::weak_ptr<detail::task> latest_producer;
-  /// To protect the access to latest_producer
-  std::mutex latest_producer_mutex;
+  /// An access of a task to a region of the root buffer
+  struct region_access {
+    /// The first element of the region, in linear order
+    std::size_t begin;
+
+    /// One past the last element of the region
+    std::size_t end;
+
+    std::weak_ptr<detail::task> task;
+
+    bool is_write_mode;
+
+    /// The in-order queue of the task, if any
+    const void *in_order_queue;
+  };
+
+  /** The accesses to the buffer which later accesses may conflict
+      with, only kept on the root buffer and shared by its sub-buffers
+
+      Any access still in the history which is older than a write
+      overlapping it is ordered before this write, so the accesses
+      fully covered by a write are forgotten.
+  */
+  std::vector<region_access> access_history;
+
+  /// To protect the access to access_history
+  std::mutex access_history_mutex;
+
+  /** For a sub-buffer, the root buffer owning the storage, which
+      holds the access history, otherwise nullptr */
+  std::shared_ptr<buffer_base> parent;
+
+  /** The region of the root buffer seen by this buffer, as a linear
+      range of elements since sub-buffers have to be contiguous */
+  std::size_t region_begin = 0;
+  std::size_t region_end = std::numeric_limits<std::size_t>::max();
 
   /// To signal when this buffer ready
   std::condition_variable ready;
@@ -87,17 +125,33 @@ struct buffer_base : public std::enable_shared_from_this<buffer_base> {
                   fresh_ctx { trisycl::context {} } {}
 
 
-  /// The destructor waits for not being used anymore
+  /** The destructor waits for not being used anymore
+
+      A sub-buffer only waits for its own users, since the tasks using
+      the root buffer do not depend on it.
+  */
   ~buffer_base() {
-    wait();
+    wait_for_users();
     // If there is the last SYCL user buffer waiting, notify it
     if (notify_buffer_destructor)
       notify_buffer_destructor->set_value();
   }
 
 
-  /// Wait for this buffer to be ready, which is no longer in use
+  /** Wait for this buffer to be ready, which is no longer in use
+
+      A sub-buffer also waits for the users of its root buffer, which
+      may access the same region.
+  */
   void wait() {
+    wait_for_users();
+    if (parent)
+      parent->wait();
+  }
+
+
+  /// Wait for the tasks using this very buffer to release it
+  void wait_for_users() {
     std::unique_lock<std::mutex> ul { ready_mutex };
     ready.wait(ul, [&] {
         // When there is no producer for this buffer, we are ready to use it
@@ -110,50 +164,135 @@ struct buffer_base : public std::enable_shared_from_this<buffer_base> {
   void use() {
     // Increment the use count
     ++number_of_users;
+    // A host accessor on the root buffer has to wait for this task too
+    if (parent)
+      parent->use();
   }
 
 
   /// A task has released the buffer
   void release() {
-    std::unique_lock<std::mutex> lock { ready_mutex };
-    if (--number_of_users == 0) {
-      // Micro-optimization: unlock before the notification
-      // https://en.cppreference.com/w/cpp/thread/condition_variable/notify_all
-      lock.unlock();
-      // Notify the host consumers or the buffer destructor that it is ready
-      ready.notify_all();
+    {
+      std::unique_lock<std::mutex> lock { ready_mutex };
+      if (--number_of_users == 0) {
+        // Micro-optimization: unlock before the notification
+        // https://en.cppreference.com/w/cpp/thread/condition_variable/notify_all
+        lock.unlock();
+        // Notify the host consumers or the buffer destructor that it is ready
+        ready.notify_all();
+      }
     }
+    if (parent)
+      parent->release();
+  }
+
+
+  /// The buffer owning the storage and the access history
+  buffer_base *root() {
+    return parent ? parent.get() : this;
   }
 
 
-  /// Return the latest producer for the buffer
+  /// Return the latest producer of some part of the buffer, if any
   std::shared_ptr<detail::task> get_latest_producer() {
-    std::lock_guard<std::mutex> lg { latest_producer_mutex };
-    // Return the valid shared_ptr to the task, if any
-    return latest_producer.lock();
+    if (parent)
+      return parent->get_latest_producer();
+    std::lock_guard<std::mutex> lg { access_history_mutex };
+    for (auto a = access_history.rbegin(); a != access_history.rend(); ++a)
+      if (a->is_write_mode)
+        // Return the valid shared_ptr to the task, if any
+        if (auto producer = a->task.lock())
+          return producer;
+    return {};
   }
 
 
-  /** Return the latest producer for the buffer and set another
-      future producer
+  /** Record an access of a task to the buffer and return the tasks it
+      conflicts with
+
+      A read only depends on the producers of the overlapping regions
+      (read-after-write), so the readers of the same data run
+      concurrently. A write also depends on the readers of the
+      overlapping regions (write-after-write and write-after-read).
+      The accesses to disjoint regions, such as through disjoint
+      sub-buffers, do not conflict.
+
+      Only the elements [begin, end) of this buffer in linear order
+      are accessed, the whole buffer by default.
+
+      The tasks already completed and released are not returned.
+
+      If the task is from the in-order queue \param in_order_queue and
+      the buffer is only used by the previous tasks of this queue, its
+      access just replaces the previous one, without any conflict.
   */
-  std::shared_ptr<detail::task>
-  set_latest_producer(std::weak_ptr<detail::task> newer_latest_producer) {
-    std::lock_guard<std::mutex> lg { latest_producer_mutex };
-    using std::swap;
+  std::vector<std::shared_ptr<detail::task>>
+  add_access(const std::shared_ptr<detail::task> &t,
+             bool is_write_mode,
+             std::size_t begin = 0,
+             std::size_t end = std::numeric_limits<std::size_t>::max(),
+             const void *in_order_queue = nullptr) {
+    return root()->add_region_access(
+      t,
+      is_write_mode,
+      region_begin + begin,
+      end == std::numeric_limits<std::size_t>::max() ? region_end
+                                                     : region_begin + end,
+      in_order_queue);
+  }
 
-    swap(newer_latest_producer, latest_producer);
-    // Return the valid shared_ptr to the previous producing task, if any
-    return newer_latest_producer.lock();
+
+  /** Record an access of a task to the linear region [begin, end) of
+      this root buffer and return the tasks it conflicts with */
+  std::vector<std::shared_ptr<detail::task>>
+  add_region_access(const std::shared_ptr<detail::task> &t,
+                    bool is_write_mode,
+                    std::size_t begin,
+                    std::size_t end,
+                    const void *in_order_queue = nullptr) {
+    std::vector<std::shared_ptr<detail::task>> conflicts;
+    std::lock_guard<std::mutex> lg { access_history_mutex };
+    if (in_order_queue && access_history.size() == 1) {
+      auto &a = access_history.front();
+      if (a.in_order_queue == in_order_queue && !a.task.expired()) {
+        /* The task runs after the one of the history, so the other
+           queues can wait for it instead, on the union of the
+           regions */
+        a = { std::min(a.begin, begin), std::max(a.end, end), t,
+              a.is_write_mode || is_write_mode, in_order_queue };
+        return conflicts;
+      }
+    }
+    auto last = std::remove_if(access_history.begin(), access_history.end(),
+                               [&] (auto &a) {
+      auto previous = a.task.lock();
+      // Forget the tasks which are gone to keep the history short
+      if (!previous)
+        return true;
+      if (a.begin < end && begin < a.end
+          && (is_write_mode || a.is_write_mode))
+        conflicts.push_back(std::move(previous));
+      return is_write_mode && begin <= a.begin && a.end <= end;
+    });
+    access_history.erase(last, access_history.end());
+    access_history.push_back({ begin, end, t, is_write_mode,
+                               in_order_queue });
+    return conflicts;
   }
 
 
-  /// Add a buffer to the task running the command group
+  /** Add a buffer to the task running the command group, accessing
+      the elements [begin, end) of the buffer in linear order */
   std::shared_ptr<detail::task>
-  add_to_task(handler *command_group_handler, bool is_write_mode) {
+  add_to_task(handler *command_group_handler,
+              bool is_write_mode,
+              std::size_t begin,
+              std::size_t end) {
     return add_buffer_to_task(command_group_handler,
                               shared_from_this(),
-                              is_write_mode);
+                              is_write_mode,
+                              begin,
+                              end);
   }
 
 
@@ -186,8 +325,14 @@ struct buffer_base : public std::enable_shared_from_this<buffer_base> {
 
   /** Transfer the most up-to-date version of the data to the host
       if the host version is not already up-to-date
+
+      If only the bytes [window_begin, window_end) are required, only
+      they are transferred and the host is still not up-to-date.
   */
-  void sync_with_host(std::size_t size, void* data) {
+  void sync_with_host(std::size_t size, void* data,
+                      std::size_t window_begin = 0,
+                      std::size_t window_end =
+                        std::numeric_limits<std::size_t>::max()) {
     trisycl::context host_context;
     if (!is_data_up_to_date(host_context) && !fresh_ctx.empty()) {
       /* We know that the context(s) in \c fresh_ctx hold the most recent
@@ -195,8 +340,15 @@ struct buffer_base : public std::enable_shared_from_this<buffer_base> {
       */
       auto fresh_context = *(fresh_ctx.begin());
       auto fresh_q = fresh_context.get_boost_queue();
-      fresh_q.enqueue_read_buffer(buffer_cache[fresh_context], 0, size, data);
-      fresh_ctx.insert(host_context);
+      if (window_begin == 0 && window_end >= size) {
+        fresh_q.enqueue_read_buffer(buffer_cache[fresh_context], 0, size, data);
+        fresh_ctx.insert(host_context);
+      }
+      else
+        fresh_q.enqueue_read_buffer(buffer_cache[fresh_context],
+                                    window_begin,
+                                    window_end - window_begin,
+                                    static_cast<char *>(data) + window_begin);
     }
   }
 
@@ -204,9 +356,21 @@ struct buffer_base : public std::enable_shared_from_this<buffer_base> {
   /** When a transfer is requested this function is called, it will
       update the state of the buffer according to the context in which
       the accessor is created and the access mode
+
+      When the accessor only uses the bytes [window_begin, window_end)
+      of the buffer, a read only transfers them, without making the
+      target context up-to-date. A write to a part of a buffer which is
+      not up-to-date in the target context still transfers the whole
+      buffer, since the target context then becomes the only one
+      up-to-date.
   */
   void update_buffer_state(const trisycl::context& target_ctx,
-                           access::mode mode, std::size_t size, void* data) {
+                           access::mode mode, std::size_t size, void* data,
+                           std::size_t window_begin = 0,
+                           std::size_t window_end =
+                             std::numeric_limits<std::size_t>::max()) {
+    // Whether the whole buffer is accessed
+    bool whole = window_begin == 0 && window_end >= size;
     /* The \c cl_buffer we put in the cache might get accessed again in the
        future, this means that we have to always to create it in read/write
        mode to be able to write to it if it is accessed through a
@@ -224,6 +388,21 @@ struct buffer_base : public std::enable_shared_from_this<buffer_base> {
         // If read mode and the data is up-to-date there is nothing to do
         return;
 
+      if (!whole) {
+        // Only the window is needed, so only transfer it
+        sync_with_host(size, data, window_begin, window_end);
+        if (!target_ctx.is_host()) {
+          if (!is_cached(target_ctx))
+            create_in_cache(target_ctx, size, flag, 0);
+          auto q = target_ctx.get_boost_queue();
+          q.enqueue_write_buffer(buffer_cache[target_ctx],
+                                 window_begin,
+                                 window_end - window_begin,
+                                 static_cast<char *>(data) + window_begin);
+        }
+        return;
+      }
+
       // The data is not up-to-date, we need a transfer
       // We also want to be sure that the host holds the most recent data
       sync_with_host(size, data);
@@ -261,9 +440,12 @@ struct buffer_base : public std::enable_shared_from_this<buffer_base> {
     */
     if (!is_data_up_to_date(target_ctx)) {
 
+      /* Even a discarding write needs the rest of the buffer when
+         only a part is written */
       if (   mode == access::mode::read_write
           || mode == access::mode::write
-          || mode == access::mode::atomic) {
+          || mode == access::mode::atomic
+          || !whole) {
         // If the data is not up-to-date in the target context
         // We want to host to be up-to-date
         sync_with_host(size, data);
@@ -285,8 +467,9 @@ struct buffer_base : public std::enable_shared_from_this<buffer_base> {
       /* When in discard mode we don't need to transfer any data, we just create
          the \c cl_buffer if it doesn't exist in the cache
       */
-      if (   mode == access::mode::discard_write
-          || mode == access::mode::discard_read_write) {
+      if (whole
+          && (   mode == access::mode::discard_write
+              || mode == access::mode::discard_read_write)) {
         /* We only need to create the buffer if it doesn't exist
            but without copying any data because of the discard mode
         */
@@ -0,0 +1,150 @@
+#ifndef TRISYCL_SYCL_BUFFER_DETAIL_FILE_MAPPING_HPP
+#define TRISYCL_SYCL_BUFFER_DETAIL_FILE_MAPPING_HPP
+
+/** \file The mapping in memory of a file used as buffer storage
+
+    This file is distributed under the University of Illinois Open Source
+    License. See LICENSE.TXT for details.
+*/
+
+#include <algorithm>
+#include <cerrno>
+#include <cstddef>
+#include <cstring>
+#include <string>
+
+#ifdef __unix__
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "triSYCL/detail/debug.hpp"
+#include "triSYCL/exception.hpp"
+#include "triSYCL/mapped_file.hpp"
+
+namespace trisycl::detail {
+
+/** \addtogroup data Data access and storage in SYCL
+    @{
+*/
+
+/** The mapping in memory of a part of a file
+
+    It is unmapped on destruction.
+*/
+class file_mapping : public detail::debug<file_mapping> {
+
+  /// The start of the mapping, aligned on a page
+  void *address = nullptr;
+
+  /// The size of the mapping
+  std::size_t length = 0;
+
+  /// The data requested, after the page alignment of the mapping
+  void *data = nullptr;
+
+  /// The writes go to the file
+  bool shared = false;
+
+public:
+
+  /** Map \param bytes bytes of the file described by \param file
+
+      \throw runtime_error if the file cannot be opened or mapped, or
+      if it is too small and not mapped with
+      mapped_file::mode::read_write_shared
+  */
+  file_mapping(const mapped_file &file, std::size_t bytes) {
+#ifdef __unix__
+    auto mode = file.get_mode();
+    shared = mode == mapped_file::mode::read_write_shared;
+    auto fail = [&] (const std::string &what) {
+      throw runtime_error { what + " " + file.get_path() + ": "
+                            + std::strerror(errno) };
+    };
+    auto fd = ::open(file.get_path().c_str(),
+                     shared ? O_RDWR | O_CREAT : O_RDONLY, 0666);
+    if (fd < 0)
+      fail("Cannot open");
+    // The file is only needed until it is mapped
+    struct closer {
+      int fd;
+      ~closer() { ::close(fd); }
+    } c { fd };
+
+    auto end = file.get_offset() + bytes;
+    struct ::stat status;
+    if (::fstat(fd, &status))
+      fail("Cannot get the size of");
+    if (std::size_t(status.st_size) < end) {
+      errno = EINVAL;
+      if (!shared || ::ftruncate(fd, end))
+        fail("Not enough data in");
+    }
+
+    // A mapping has to start on a page boundary
+    auto head = file.get_offset() % ::sysconf(_SC_PAGESIZE);
+    // mmap() refuses an empty mapping
+    length = std::max<std::size_t>(head + bytes, 1);
+    address = ::mmap(nullptr,
+                     length,
+                     mode == mapped_file::mode::read_only
+                     ? PROT_READ : PROT_READ | PROT_WRITE,
+                     mode == mapped_file::mode::read_write_private
+                     ? MAP_PRIVATE : MAP_SHARED,
+                     fd,
+                     file.get_offset() - head);
+    if (address == MAP_FAILED) {
+      address = nullptr;
+      fail("Cannot map");
+    }
+    data = static_cast<char *>(address) + head;
+#else
+    throw feature_not_supported { "Mapping a file is not supported" };
+#endif
+  }
+
+
+  /// Get the address of the data requested
+  void *get_data() const {
+    return data;
+  }
+
+
+  /// Write the modifications to the file, if they go to the file
+  void sync() {
+#ifdef __unix__
+    if (shared)
+      ::msync(address, length, MS_SYNC);
+#endif
+  }
+
+
+  ~file_mapping() {
+#ifdef __unix__
+    if (address)
+      ::munmap(address, length);
+#endif
+  }
+
+
+  file_mapping(const file_mapping &) = delete;
+  file_mapping &operator=(const file_mapping &) = delete;
+
+};
+
+/// @} End the data Doxygen group
+
+}
+
+/*
+    # Some Emacs stuff:
+    ### Local Variables:
+    ### ispell-local-dictionary: "american"
+    ### eval: (flyspell-prog-mode)
+    ### End:
+*/
+
+#endif // TRISYCL_SYCL_BUFFER_DETAIL_FILE_MAPPING_HPP
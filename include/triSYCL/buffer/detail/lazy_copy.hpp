@@ -0,0 +1,113 @@
+#ifndef TRISYCL_SYCL_BUFFER_DETAIL_LAZY_COPY_HPP
+#define TRISYCL_SYCL_BUFFER_DETAIL_LAZY_COPY_HPP
+
+/** \file A copy of memory done page by page when the pages are needed
+
+    This file is distributed under the University of Illinois Open Source
+    License. See LICENSE.TXT for details.
+*/
+
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <mutex>
+#include <vector>
+
+#include "triSYCL/buffer/detail/page_allocation.hpp"
+#include "triSYCL/detail/debug.hpp"
+
+namespace trisycl::detail {
+
+/** \addtogroup data Data access and storage in SYCL
+    @{
+*/
+
+/** A copy of some memory to some uninitialized memory, done page by
+    page only for the parts requested
+
+    This implements the copy on write of a buffer built from const host
+    data: only the pages in the windows of the accessors created after
+    the first write are copied and the pages outside of them are not
+    even touched in the copy.
+
+    The copy is still eager for the whole window of an accessor, when
+    the accessor is created, whatever the elements its kernel really
+    uses. So an accessor on the whole buffer copies the whole buffer,
+    as before. Copying on the first touch of a page would need to
+    protect the copy with mprotect() and to catch the faults in a
+    SIGSEGV handler, which a library cannot install without
+    interfering with the handlers of the application.
+*/
+class lazy_copy : public detail::debug<lazy_copy> {
+
+  const char *source;
+
+  char *target;
+
+  std::size_t bytes;
+
+  /// The pages of the target already holding their final content
+  std::vector<bool> copied;
+
+  /// The number of pages still to copy
+  std::size_t remaining;
+
+  /// To protect the copies from concurrent accessor creations
+  std::mutex copied_mutex;
+
+public:
+
+  /// Prepare the copy of \param bytes bytes from \param source to \param target
+  lazy_copy(const void *source, void *target, std::size_t bytes)
+    : source { static_cast<const char *>(source) },
+      target { static_cast<char *>(target) },
+      bytes { bytes },
+      copied(round_up(bytes, page_size)/page_size),
+      remaining { copied.size() }
+  {}
+
+
+  /** Make sure the bytes [\param begin, \param end) of the target hold
+      the source content
+
+      With \param discard the previous content is not needed, so only
+      the pages not fully in the range are copied.
+  */
+  void copy(std::size_t begin, std::size_t end, bool discard) {
+    std::lock_guard<std::mutex> lg { copied_mutex };
+    end = std::min(end, bytes);
+    for (auto page = begin/page_size; page*page_size < end; ++page)
+      if (!copied[page]) {
+        auto page_begin = page*page_size;
+        auto page_end = std::min(page_begin + page_size, bytes);
+        if (!discard || page_begin < begin || page_end > end)
+          std::memcpy(target + page_begin,
+                      source + page_begin,
+                      page_end - page_begin);
+        copied[page] = true;
+        --remaining;
+      }
+  }
+
+
+  /// Test whether the whole target holds its final content
+  bool done() {
+    std::lock_guard<std::mutex> lg { copied_mutex };
+    return !remaining;
+  }
+
+};
+
+/// @} End the data Doxygen group
+
+}
+
+/*
+    # Some Emacs stuff:
+    ### Local Variables:
+    ### ispell-local-dictionary: "american"
+    ### eval: (flyspell-prog-mode)
+    ### End:
+*/
+
+#endif // TRISYCL_SYCL_BUFFER_DETAIL_LAZY_COPY_HPP
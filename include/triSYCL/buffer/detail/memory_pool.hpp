@@ -0,0 +1,130 @@
+#ifndef TRISYCL_SYCL_BUFFER_DETAIL_MEMORY_POOL_HPP
+#define TRISYCL_SYCL_BUFFER_DETAIL_MEMORY_POOL_HPP
+
+/** \file A process-wide pool of memory blocks recycled across the
+    buffer lifetimes
+
+    This file is distributed under the University of Illinois Open Source
+    License. See LICENSE.TXT for details.
+*/
+
+#include <cstddef>
+#include <mutex>
+#include <new>
+#include <unordered_map>
+#include <vector>
+
+#include "triSYCL/detail/debug.hpp"
+#include "triSYCL/detail/singleton.hpp"
+
+namespace trisycl::detail {
+
+/** \addtogroup data Data access and storage in SYCL
+    @{
+*/
+
+/** A pool of memory blocks sorted by alignment and size classes
+
+    A freed block is kept to be reused by the next allocation of the
+    same alignment and size class instead of being returned to the
+    system, so creating and destroying buffers of the same size again
+    and again costs neither system allocation nor page faults.
+
+    The size classes are the multiples of a quarter of the previous
+    power of 2, so at most 25% of a block is wasted.
+*/
+class memory_pool : public detail::singleton<memory_pool>,
+                    public detail::debug<memory_pool> {
+
+  /// The smallest block, to avoid many tiny classes
+  static constexpr std::size_t min_block = 64;
+
+  /// The free blocks of each size class, for each alignment
+  std::unordered_map<std::size_t,
+                     std::unordered_map<std::size_t, std::vector<void *>>>
+  free_blocks;
+
+  /// To protect the access to free_blocks
+  std::mutex free_blocks_mutex;
+
+  // Only the singleton can construct it
+  friend detail::singleton<memory_pool>;
+
+  memory_pool() = default;
+
+public:
+
+  /// Round a size in bytes up to its size class
+  static std::size_t size_class(std::size_t bytes) {
+    if (bytes <= min_block)
+      return min_block;
+    // The exponent of the power of 2 just below bytes
+    int log2 = 0;
+    for (auto b = bytes - 1; b >>= 1;)
+      ++log2;
+    auto step = std::size_t { 1 } << (log2 - 2);
+    return (bytes + step - 1) & ~(step - 1);
+  }
+
+
+  /// Get a block of at least \param bytes bytes aligned on \param alignment
+  void *allocate(std::size_t bytes,
+                 std::size_t alignment = __STDCPP_DEFAULT_NEW_ALIGNMENT__) {
+    auto size = size_class(bytes);
+    {
+      std::lock_guard<std::mutex> lg { free_blocks_mutex };
+      auto &blocks = free_blocks[alignment][size];
+      if (!blocks.empty()) {
+        auto p = blocks.back();
+        blocks.pop_back();
+        return p;
+      }
+    }
+    if (alignment > __STDCPP_DEFAULT_NEW_ALIGNMENT__)
+      return ::operator new(size, std::align_val_t { alignment });
+    return ::operator new(size);
+  }
+
+
+  /** Give back a block of \param bytes bytes allocated with
+      \param alignment for later reuse */
+  void deallocate(void *p, std::size_t bytes,
+                  std::size_t alignment = __STDCPP_DEFAULT_NEW_ALIGNMENT__) {
+    std::lock_guard<std::mutex> lg { free_blocks_mutex };
+    free_blocks[alignment][size_class(bytes)].push_back(p);
+  }
+
+
+  /// Return all the free blocks to the system
+  void release() {
+    std::lock_guard<std::mutex> lg { free_blocks_mutex };
+    for (auto &[alignment, classes] : free_blocks)
+      for (auto &c : classes)
+        for (auto p : c.second)
+          if (alignment > __STDCPP_DEFAULT_NEW_ALIGNMENT__)
+            ::operator delete(p, std::align_val_t { alignment });
+          else
+            ::operator delete(p);
+    free_blocks.clear();
+  }
+
+
+  ~memory_pool() {
+    release();
+  }
+
+};
+
+/// @} End the data Doxygen group
+
+}
+
+/*
+    # Some Emacs stuff:
+    ### Local Variables:
+    ### ispell-local-dictionary: "american"
+    ### eval: (flyspell-prog-mode)
+    ### End:
+*/
+
+#endif // TRISYCL_SYCL_BUFFER_DETAIL_MEMORY_POOL_HPP
@@ -0,0 +1,133 @@
+#ifndef TRISYCL_SYCL_BUFFER_DETAIL_PAGE_ALLOCATION_HPP
+#define TRISYCL_SYCL_BUFFER_DETAIL_PAGE_ALLOCATION_HPP
+
+/** \file Allocation of buffer memory directly from the operating
+    system, by whole pages
+
+    This file is distributed under the University of Illinois Open Source
+    License. See LICENSE.TXT for details.
+*/
+
+#include <cstddef>
+#include <cstdint>
+#include <new>
+
+#ifdef __unix__
+#include <sys/mman.h>
+#endif
+
+namespace trisycl::detail {
+
+/** \addtogroup data Data access and storage in SYCL
+    @{
+*/
+
+/// The alignment avoiding to share a cache line with other data
+inline constexpr std::size_t cache_line_size = 64;
+
+/// The smallest size of the pages on the usual systems
+inline constexpr std::size_t page_size = 4096;
+
+/// The size of the huge pages used for the large buffers
+inline constexpr std::size_t huge_page_size = std::size_t { 2 } << 20;
+
+
+/// Round \param n up to a multiple of the power of 2 \param alignment
+constexpr std::size_t round_up(std::size_t n, std::size_t alignment) {
+  return (n + alignment - 1) & ~(alignment - 1);
+}
+
+
+/** Allocate memory backed by huge pages when possible
+
+    First try the explicit huge pages reserved by the system
+    administrator. If there is none, map normal pages aligned on a huge
+    page boundary and advise the kernel to back them with transparent
+    huge pages. Without mmap(), just use aligned memory.
+
+    The memory is always aligned on a huge page boundary.
+*/
+inline void *allocate_huge_pages(std::size_t bytes) {
+  auto size = round_up(bytes, huge_page_size);
+#ifdef __unix__
+  void *p;
+#ifdef MAP_HUGETLB
+  p = ::mmap(nullptr, size, PROT_READ | PROT_WRITE,
+             MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+  if (p != MAP_FAILED)
+    return p;
+#endif
+  // Map a huge page more to be able to align the start
+  p = ::mmap(nullptr, size + huge_page_size, PROT_READ | PROT_WRITE,
+             MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  if (p == MAP_FAILED)
+    throw std::bad_alloc {};
+  auto start = reinterpret_cast<std::uintptr_t>(p);
+  auto head = round_up(start, huge_page_size) - start;
+  auto aligned = static_cast<char *>(p) + head;
+  // Give back the unaligned head and the unused tail
+  if (head)
+    ::munmap(p, head);
+  if (head != huge_page_size)
+    ::munmap(aligned + size, huge_page_size - head);
+#ifdef MADV_HUGEPAGE
+  // It does not matter if transparent huge pages are disabled
+  ::madvise(aligned, size, MADV_HUGEPAGE);
+#endif
+  return aligned;
+#else
+  return ::operator new(size, std::align_val_t { huge_page_size });
+#endif
+}
+
+
+/** Allocate memory directly from the system by whole pages
+
+    The pages are not touched, so their physical placement can still
+    be chosen. Without mmap(), just use memory aligned on a page.
+*/
+inline void *allocate_pages(std::size_t bytes) {
+#ifdef __unix__
+  auto p = ::mmap(nullptr, bytes, PROT_READ | PROT_WRITE,
+                  MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  if (p == MAP_FAILED)
+    throw std::bad_alloc {};
+  return p;
+#else
+  return ::operator new(bytes, std::align_val_t { page_size });
+#endif
+}
+
+
+/// Give back the memory from allocate_pages(\param bytes)
+inline void deallocate_pages(void *p, std::size_t bytes) {
+#ifdef __unix__
+  ::munmap(p, bytes);
+#else
+  ::operator delete(p, std::align_val_t { page_size });
+#endif
+}
+
+
+/// Give back the memory from allocate_huge_pages(\param bytes)
+inline void deallocate_huge_pages(void *p, std::size_t bytes) {
+#ifdef __unix__
+  ::munmap(p, round_up(bytes, huge_page_size));
+#else
+  ::operator delete(p, std::align_val_t { huge_page_size });
+#endif
+}
+
+/// @} End the data Doxygen group
+
+}
+
+/*
+    # Some Emacs stuff:
+    ### Local Variables:
+    ### ispell-local-dictionary: "american"
+    ### eval: (flyspell-prog-mode)
+    ### End:
+*/
+
+#endif // TRISYCL_SYCL_BUFFER_DETAIL_PAGE_ALLOCATION_HPP
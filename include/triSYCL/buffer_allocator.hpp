@@ -9,8 +9,14 @@
     License. See LICENSE.TXT for details.
 */
 
+#include <algorithm>
 #include <cstddef>
 #include <memory>
+#include <new>
+
+#include "triSYCL/buffer/detail/memory_pool.hpp"
+#include "triSYCL/buffer/detail/page_allocation.hpp"
+#include "triSYCL/detail/numa.hpp"
 
 namespace trisycl {
 
@@ -26,6 +32,267 @@ namespace trisycl {
 template <typename T>
 using buffer_allocator = std::allocator<T>;
 
+
+/** A buffer allocator recycling the memory of the destroyed buffers
+
+    The memory of a buffer is given back to a process-wide pool on
+    destruction and reused by the next buffer of a similar size, which
+    avoids the system allocation and the page faults when buffers of
+    the same size are created again and again, such as temporary
+    buffers in a time-stepping loop.
+
+    This is a triSYCL extension.
+*/
+template <typename T>
+class pooled_buffer_allocator {
+
+public:
+
+  using value_type = T;
+
+  pooled_buffer_allocator() = default;
+
+
+  /// Allow the rebinding to another type
+  template <typename U>
+  pooled_buffer_allocator(const pooled_buffer_allocator<U> &) {}
+
+
+  /** Allocate memory for \param n elements, recycling if possible,
+      with the alignment of T even for an over-aligned type */
+  T *allocate(std::size_t n) {
+    return static_cast<T *>(detail::memory_pool::instance()
+                            ->allocate(n*sizeof(T), alignment()));
+  }
+
+
+  /// Give back the memory of \param n elements to the pool
+  void deallocate(T *p, std::size_t n) {
+    detail::memory_pool::instance()->deallocate(p, n*sizeof(T), alignment());
+  }
+
+
+  /** Return the memory kept in the pool to the system, for example
+      at the end of a phase using a lot of temporary buffers */
+  static void release() {
+    detail::memory_pool::instance()->release();
+  }
+
+private:
+
+  /// The alignment of the blocks, at least the one of operator new
+  static constexpr std::size_t alignment() {
+    return std::max<std::size_t>(alignof(T), __STDCPP_DEFAULT_NEW_ALIGNMENT__);
+  }
+
+};
+
+
+/// All the pooled allocators share the same pool, so they are equal
+template <typename T, typename U>
+bool operator==(const pooled_buffer_allocator<T> &,
+                const pooled_buffer_allocator<U> &) {
+  return true;
+}
+
+
+template <typename T, typename U>
+bool operator!=(const pooled_buffer_allocator<T> &,
+                const pooled_buffer_allocator<U> &) {
+  return false;
+}
+
+
+/** A buffer allocator aligning the memory on \p Alignment bytes,
+    on a cache line by default
+
+    This allows aligned vector loads and stores in the kernels.
+
+    This is a triSYCL extension.
+*/
+template <typename T, std::size_t Alignment = detail::cache_line_size>
+class aligned_buffer_allocator {
+
+  static_assert(Alignment >= alignof(T) && (Alignment & (Alignment - 1)) == 0,
+                "The alignment has to be a power of 2 at least the one "
+                "of the type");
+
+public:
+
+  using value_type = T;
+
+  /// The non-type template parameter prevents the automatic rebinding
+  template <typename U>
+  struct rebind {
+    using other = aligned_buffer_allocator<U, Alignment>;
+  };
+
+  aligned_buffer_allocator() = default;
+
+
+  template <typename U>
+  aligned_buffer_allocator(const aligned_buffer_allocator<U, Alignment> &) {}
+
+
+  T *allocate(std::size_t n) {
+    return static_cast<T *>(::operator new(n*sizeof(T),
+                                           std::align_val_t { Alignment }));
+  }
+
+
+  void deallocate(T *p, std::size_t) {
+    ::operator delete(p, std::align_val_t { Alignment });
+  }
+
+};
+
+
+template <typename T, typename U, std::size_t Alignment>
+bool operator==(const aligned_buffer_allocator<T, Alignment> &,
+                const aligned_buffer_allocator<U, Alignment> &) {
+  return true;
+}
+
+
+template <typename T, typename U, std::size_t Alignment>
+bool operator!=(const aligned_buffer_allocator<T, Alignment> &,
+                const aligned_buffer_allocator<U, Alignment> &) {
+  return false;
+}
+
+
+/** A buffer allocator using huge pages for the large buffers, to
+    reduce the TLB misses
+
+    The buffers of at least a huge page use the explicit huge pages
+    if some are reserved by the system, otherwise memory aligned on a
+    huge page boundary advised to be backed by transparent huge pages.
+    The smaller buffers are aligned on a cache line.
+
+    This is a triSYCL extension.
+*/
+template <typename T>
+class huge_page_buffer_allocator {
+
+public:
+
+  using value_type = T;
+
+  huge_page_buffer_allocator() = default;
+
+
+  template <typename U>
+  huge_page_buffer_allocator(const huge_page_buffer_allocator<U> &) {}
+
+
+  T *allocate(std::size_t n) {
+    if (n*sizeof(T) >= detail::huge_page_size)
+      return static_cast<T *>(detail::allocate_huge_pages(n*sizeof(T)));
+    return aligned_buffer_allocator<T> {}.allocate(n);
+  }
+
+
+  void deallocate(T *p, std::size_t n) {
+    if (n*sizeof(T) >= detail::huge_page_size)
+      detail::deallocate_huge_pages(p, n*sizeof(T));
+    else
+      aligned_buffer_allocator<T> {}.deallocate(p, n);
+  }
+
+};
+
+
+template <typename T, typename U>
+bool operator==(const huge_page_buffer_allocator<T> &,
+                const huge_page_buffer_allocator<U> &) {
+  return true;
+}
+
+
+template <typename T, typename U>
+bool operator!=(const huge_page_buffer_allocator<T> &,
+                const huge_page_buffer_allocator<U> &) {
+  return false;
+}
+
+/** A buffer allocator placing the memory on the NUMA nodes
+
+    With numa_policy::first_touch, the default, the pages are touched
+    at allocation by the threads of a parallel loop with the static
+    partition used by the parallel_for kernels on the buffer range.
+    So the kernels find most of their data on their own node,
+    especially with the thread pinning of
+    property::queue::pin_threads.
+
+    With numa_policy::interleave the pages are distributed on all the
+    nodes, which balances the memory bandwidth when the access pattern
+    is not known, and numa_policy::bind places them on a given node.
+
+    This is a triSYCL extension.
+*/
+template <typename T>
+class numa_buffer_allocator {
+
+  numa_policy policy;
+
+  /// The node used by numa_policy::bind
+  int node;
+
+  template <typename U>
+  friend class numa_buffer_allocator;
+
+public:
+
+  using value_type = T;
+
+  numa_buffer_allocator(numa_policy policy = numa_policy::first_touch,
+                        int node = 0)
+    : policy { policy }, node { node } {}
+
+
+  /// Allow the rebinding to another type with the same placement
+  template <typename U>
+  numa_buffer_allocator(const numa_buffer_allocator<U> &other)
+    : policy { other.policy }, node { other.node } {}
+
+
+  T *allocate(std::size_t n) {
+    auto bytes = std::max<std::size_t>(1, n*sizeof(T));
+    auto p = detail::allocate_pages(bytes);
+    if (policy == numa_policy::first_touch)
+      detail::numa::first_touch(p, n, sizeof(T));
+    else
+      detail::numa::place(p, bytes, policy, node);
+    return static_cast<T *>(p);
+  }
+
+
+  void deallocate(T *p, std::size_t n) {
+    detail::deallocate_pages(p, std::max<std::size_t>(1, n*sizeof(T)));
+  }
+
+
+  numa_policy get_policy() const { return policy; }
+
+
+  int get_node() const { return node; }
+
+};
+
+
+template <typename T, typename U>
+bool operator==(const numa_buffer_allocator<T> &a,
+                const numa_buffer_allocator<U> &b) {
+  return a.get_policy() == b.get_policy() && a.get_node() == b.get_node();
+}
+
+
+template <typename T, typename U>
+bool operator!=(const numa_buffer_allocator<T> &a,
+                const numa_buffer_allocator<U> &b) {
+  return !(a == b);
+}
+
 /// @} End the data Doxygen group
 
 }
@@ -0,0 +1,91 @@
+#ifndef TRISYCL_SYCL_COMMAND_GRAPH_HPP
+#define TRISYCL_SYCL_COMMAND_GRAPH_HPP
+
+/** \file The command_graph class to record and replay command groups
+
+    This file is distributed under the University of Illinois Open Source
+    License. See LICENSE.TXT for details.
+*/
+
+#include <cstddef>
+#include <memory>
+
+#include "triSYCL/command_group/detail/command_graph.hpp"
+#include "triSYCL/detail/shared_ptr_implementation.hpp"
+
+namespace trisycl {
+
+/** \addtogroup execution Platforms, contexts, devices and queues
+    @{
+*/
+
+/** A sequence of command groups recorded from a queue, to be replayed
+    many times with a low host overhead
+
+    The command groups submitted to a queue between
+    queue::begin_recording() and queue::end_recording() are not
+    executed but recorded, with their accessors and the dependencies
+    between them. Then each queue::replay() executes them again on the
+    same buffers as a single command group, without running the
+    command group functors again.
+
+    Since the recorded kernels keep their accessors, the buffers they
+    use live at least as long as the graph, so a graph has to be
+    destroyed before the buffers with a blocking destructor.
+
+    This is a triSYCL extension.
+*/
+class command_graph
+  : public detail::shared_ptr_implementation<command_graph,
+                                             detail::command_graph> {
+
+  // The type encapsulating the implementation
+  using implementation_t = typename command_graph::shared_ptr_implementation;
+
+  // Allows the comparison operation to access the implementation
+  friend implementation_t;
+
+public:
+
+  /// Create an empty graph
+  command_graph() : implementation_t { new detail::command_graph } {}
+
+
+  /// Get the number of command groups recorded in the graph
+  std::size_t size() const {
+    return implementation->nodes.size();
+  }
+
+};
+
+/// @} End the execution Doxygen group
+
+}
+
+/* Inject a custom specialization of std::hash to have the command_graph
+   usable into an unordered associative container
+
+   \todo Add this to the spec
+*/
+namespace std {
+
+template <> struct hash<trisycl::command_graph> {
+
+  auto operator()(const trisycl::command_graph &g) const {
+    // Forward the hashing to the implementation
+    return g.hash();
+  }
+
+};
+
+}
+
+/*
+    # Some Emacs stuff:
+    ### Local Variables:
+    ### ispell-local-dictionary: "american"
+    ### eval: (flyspell-prog-mode)
+    ### End:
+*/
+
+#endif // TRISYCL_SYCL_COMMAND_GRAPH_HPP
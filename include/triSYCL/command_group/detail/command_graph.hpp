@@ -0,0 +1,252 @@
+#ifndef TRISYCL_SYCL_COMMAND_GROUP_DETAIL_COMMAND_GRAPH_HPP
+#define TRISYCL_SYCL_COMMAND_GROUP_DETAIL_COMMAND_GRAPH_HPP
+
+/** \file The recorded command groups behind a command_graph
+
+    This file is distributed under the University of Illinois Open Source
+    License. See LICENSE.TXT for details.
+*/
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "triSYCL/buffer/detail/buffer_base.hpp"
+#include "triSYCL/command_group/detail/executor.hpp"
+#include "triSYCL/command_group/detail/task.hpp"
+#include "triSYCL/detail/debug.hpp"
+#include "triSYCL/exception.hpp"
+
+namespace trisycl::detail {
+
+/** \addtogroup execution Platforms, contexts, devices and queues
+    @{
+*/
+
+/** A graph of recorded tasks, with the dependencies between them
+    computed once at recording time
+
+    Replaying the graph does not run any command group functor,
+    accessor construction or dependency analysis again: the whole graph
+    is executed by a single task registered once to each buffer it
+    uses, and inside it the recorded tasks are run as soon as their
+    precomputed predecessors have completed. The last of them
+    completes the task of the replay.
+*/
+struct command_graph : detail::debug<detail::command_graph> {
+
+  /// A recorded task with its position in the graph
+  struct node {
+    std::shared_ptr<detail::task> task;
+
+    /// Number of nodes to complete before this one can run
+    std::size_t predecessors = 0;
+
+    /// The nodes depending on this one
+    std::vector<std::size_t> successors;
+  };
+
+  /// The access history of a buffer inside the graph
+  struct access_history {
+    /// The latest node writing the buffer, if any
+    std::ptrdiff_t latest_producer = -1;
+
+    /// The nodes reading the buffer since the latest producer
+    std::vector<std::size_t> active_readers;
+
+    /// Whether a node of the graph writes the buffer
+    bool written = false;
+  };
+
+  /// The recorded tasks in submission order, which is a topological order
+  std::vector<node> nodes;
+
+  /// The buffers used by the graph, in first use order
+  std::vector<std::shared_ptr<detail::buffer_base>> buffers;
+
+  /** The access history of each root buffer used by the graph
+
+      The sub-buffers share the history of their root buffer, so the
+      recorded tasks accessing disjoint sub-buffers are still ordered
+      inside the graph.
+  */
+  std::unordered_map<detail::buffer_base *, access_history> histories;
+
+  /// The node of each recorded task
+  std::unordered_map<detail::task *, std::size_t> node_index;
+
+  /** The tasks outside of the graph some recorded tasks explicitly
+      depend on, to be waited for by each replay */
+  std::vector<std::weak_ptr<detail::task>> external_producers;
+
+
+  /// Add an edge between 2 nodes, if not already there
+  void add_dependency(std::size_t from, std::size_t to) {
+    auto &s = nodes[from].successors;
+    if (from != to && std::find(s.begin(), s.end(), to) == s.end()) {
+      s.push_back(to);
+      ++nodes[to].predecessors;
+    }
+  }
+
+
+  /** Record a task, with its dependencies on the previous ones
+      following the same read-after-write, write-after-read and
+      write-after-write rules as the buffers
+
+      \throw invalid_object_error if the task depends on a task
+      recorded in another graph, which is never executed by itself
+  */
+  void add(const std::shared_ptr<detail::task> &t) {
+    // A command group without kernel has nothing to replay
+    if (!t->kernel_body)
+      return;
+    for (auto &p : t->producer_tasks)
+      if (p->recorded && !node_index.count(p.get()))
+        throw invalid_object_error("A recorded command group cannot depend "
+                                   "on another command_graph");
+    const std::size_t n = nodes.size();
+    nodes.push_back({ t, 0, {} });
+    node_index.emplace(t.get(), n);
+    // The explicit dependencies, from handler::depends_on()
+    for (auto &p : t->producer_tasks) {
+      auto i = node_index.find(p.get());
+      if (i != node_index.end())
+        add_dependency(i->second, n);
+      else
+        external_producers.push_back(p);
+    }
+    t->producer_tasks.clear();
+    for (auto &[b, is_write_mode] : t->recorded_accesses) {
+      if (std::find(buffers.begin(), buffers.end(), b) == buffers.end())
+        buffers.push_back(b);
+      auto &history = histories[b->root()];
+      if (history.latest_producer >= 0)
+        add_dependency(history.latest_producer, n);
+      if (is_write_mode) {
+        for (auto r : history.active_readers)
+          add_dependency(r, n);
+        history.active_readers.clear();
+        history.latest_producer = n;
+        history.written = true;
+      }
+      else
+        history.active_readers.push_back(n);
+    }
+    // The buffers are tracked by the graph from now
+    t->recorded_accesses.clear();
+  }
+
+
+  /// Make the task replaying the graph wait for the external producers
+  void add_external_producers(detail::task &replay) {
+    for (auto &p : external_producers)
+      if (auto producer = p.lock())
+        replay.add_producer(std::move(producer));
+  }
+
+
+  /// The progress of a replay of a graph, shared by its running nodes
+  struct replay_state {
+    std::shared_ptr<command_graph> graph;
+
+    /// The task replaying the graph, to complete after the last node
+    std::shared_ptr<detail::task> replay;
+
+    /// Number of predecessors of each node still to complete
+    std::vector<std::atomic<std::size_t>> pending;
+
+    /// Number of nodes still to complete
+    std::atomic<std::size_t> remaining;
+
+    replay_state(std::shared_ptr<command_graph> graph,
+                 std::shared_ptr<detail::task> replay)
+      : graph { std::move(graph) }
+      , replay { std::move(replay) }
+      , pending(this->graph->nodes.size())
+      , remaining { this->graph->nodes.size() } {
+      for (std::size_t i = 0; i != pending.size(); ++i)
+        pending[i] = this->graph->nodes[i].predecessors;
+    }
+  };
+
+
+  /** Run a node of a replay and then the successors it makes ready
+
+      A node whose predecessors are completed is run by the thread
+      completing the last of them, the other ready nodes being
+      submitted to the executor, so a chain of kernels is run by a
+      single thread without any synchronization.
+  */
+  static void run(const std::shared_ptr<replay_state> &state,
+                  std::size_t i) {
+    auto &nodes = state->graph->nodes;
+    for (;;) {
+      nodes[i].task->execute_recorded(*state->replay->owner_queue);
+      std::ptrdiff_t next = -1;
+      for (auto s : nodes[i].successors)
+        if (--state->pending[s] == 0) {
+          if (next < 0)
+            next = s;
+          else
+            executor::instance()->submit([state, s] { run(state, s); });
+        }
+      if (--state->remaining == 0)
+        state->replay->complete();
+      if (next < 0)
+        return;
+      i = next;
+    }
+  }
+
+
+  /** Run the graph once on behalf of the task \param replay
+
+      No thread waits for the end of the replay: the task is completed
+      by the thread running the last node, so it has to be scheduled
+      with task::completed_by_kernel.
+  */
+  static void execute(const std::shared_ptr<command_graph> &graph,
+                      const std::shared_ptr<detail::task> &replay) {
+    auto state = std::make_shared<replay_state>(graph, replay);
+    std::vector<std::size_t> roots;
+    for (std::size_t i = 0; i != graph->nodes.size(); ++i)
+      if (graph->nodes[i].predecessors == 0)
+        roots.push_back(i);
+    if (roots.empty()) {
+      // An empty graph
+      replay->complete();
+      return;
+    }
+    for (std::size_t r = 1; r < roots.size(); ++r)
+      executor::instance()->submit([state, i = roots[r]] { run(state, i); });
+    run(state, roots.front());
+  }
+
+
+  /** Break the ownership cycles between the recorded tasks and their
+      kernels, which own the accessors and thus the buffers */
+  ~command_graph() {
+    for (auto &n : nodes)
+      n.task->forget_recorded();
+  }
+
+};
+
+/// @} End the execution Doxygen group
+
+}
+
+/*
+    # Some Emacs stuff:
+    ### Local Variables:
+    ### ispell-local-dictionary: "american"
+    ### eval: (flyspell-prog-mode)
+    ### End:
+*/
+
+#endif // TRISYCL_SYCL_COMMAND_GROUP_DETAIL_COMMAND_GRAPH_HPP
@@ -0,0 +1,333 @@
+#ifndef TRISYCL_SYCL_COMMAND_GROUP_DETAIL_EXECUTOR_HPP
+#define TRISYCL_SYCL_COMMAND_GROUP_DETAIL_EXECUTOR_HPP
+
+/** \file The host executor running the tasks on a pool of persistent
+    threads
+
+    Ronan at Keryell point FR
+
+    This file is distributed under the University of Illinois Open Source
+    License. See LICENSE.TXT for details.
+*/
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+#include "triSYCL/detail/debug.hpp"
+#include "triSYCL/detail/singleton.hpp"
+
+namespace trisycl::detail {
+
+/** \addtogroup execution Platforms, contexts, devices and queues
+    @{
+*/
+
+/** A process-wide pool of persistent worker threads executing the
+    runnable tasks
+
+    Each worker owns a deque of jobs. A worker pushes and pops the jobs
+    it produces itself at the back of its own deque to keep the cache
+    warm along a chain of dependent tasks, while idle workers steal the
+    oldest jobs from the front of the other deques.
+
+    Up to \c concurrency workers are started on demand. Since some
+    kernels can block waiting for each other, for example through
+    blocking pipes, more workers are injected by a monitor thread when
+    some jobs are pending while all the workers are busy without any
+    progress. This keeps the forward-progress guarantee that a thread
+    per task used to provide, with an exponential back-off to avoid
+    oversubscription with long-running kernels.
+
+    \todo Retire the injected workers after some idle time
+*/
+class executor : public detail::singleton<executor>,
+                 public detail::debug<executor> {
+
+public:
+
+  /// The type of the work to be done by a worker
+  using job = std::function<void(void)>;
+
+  /// Upper bound on the number of workers to have a static worker table
+  static constexpr std::size_t max_workers = 256;
+
+private:
+
+  /// A worker thread with its own job deque
+  struct worker {
+    /// The jobs owned by this worker
+    std::deque<job> jobs;
+    /// To protect the access to the jobs
+    std::mutex jobs_mutex;
+    /// The thread running the worker
+    std::thread thread;
+  };
+
+  /** The worker table
+
+      Only the \c started first elements are valid and they are never
+      removed, so other workers can look at them without locking the
+      table.
+  */
+  std::array<std::unique_ptr<worker>, max_workers> workers;
+
+  /// Number of valid workers in the table
+  std::atomic<std::size_t> started { 0 };
+
+  /// To serialize the worker creation
+  std::mutex start_mutex;
+
+  /// Number of workers to start eagerly when there is some work to do
+  std::atomic<std::size_t> concurrency;
+
+  /// Number of workers waiting for some jobs
+  std::atomic<std::size_t> idle { 0 };
+
+  /// Number of jobs waiting in all the deques
+  std::atomic<std::size_t> queued { 0 };
+
+  /// Number of jobs executed so far, to detect starvation
+  std::atomic<std::size_t> completed { 0 };
+
+  /// Round-robin distribution of the jobs submitted from outside
+  std::atomic<std::size_t> next_worker { 0 };
+
+  /// To signal the idle workers there is something to do
+  std::condition_variable wake;
+  /// To protect the access to the condition variable
+  std::mutex wake_mutex;
+
+  /// The thread injecting more workers on starvation
+  std::thread monitor;
+
+  /// To signal the monitor that all the workers are busy
+  std::condition_variable monitor_wake;
+  /// To protect the access to the monitor condition variable
+  std::mutex monitor_mutex;
+
+  /// Request the workers and the monitor to exit
+  std::atomic<bool> stop { false };
+
+  /// Minimum delay without progress before injecting a new worker
+  static constexpr std::chrono::milliseconds starvation_delay { 10 };
+
+  /// The worker the current thread is, if any
+  static inline thread_local worker *current_worker = nullptr;
+
+  // Only the singleton can construct it
+  friend detail::singleton<executor>;
+
+  /// By default use as many workers as hardware threads
+  executor()
+    : concurrency { std::max<std::size_t>(1,
+                                          std::thread::hardware_concurrency()) }
+  {}
+
+public:
+
+  /** Set the number of workers to start eagerly
+
+      It cannot be more than \c max_workers and the workers already
+      started are not stopped.
+  */
+  void set_concurrency(std::size_t n) {
+    concurrency = std::clamp<std::size_t>(n, 1, max_workers);
+  }
+
+
+  /// Get the number of workers started eagerly
+  std::size_t get_concurrency() const {
+    return concurrency;
+  }
+
+
+  /// Get the number of workers started so far
+  std::size_t get_worker_count() const {
+    return started;
+  }
+
+
+  /// Test whether the current thread is a worker of the executor
+  static bool is_worker_thread() {
+    return current_worker != nullptr;
+  }
+
+
+  /** Submit a job to be executed by some worker
+
+      From a worker the job is pushed on its own deque, otherwise the
+      jobs are distributed round-robin on the workers.
+  */
+  void submit(job j) {
+    worker *w = current_worker;
+    if (!w) {
+      if (started == 0)
+        start_worker();
+      auto n = started.load(std::memory_order_acquire);
+      w = workers[next_worker++ % n].get();
+    }
+    {
+      std::lock_guard<std::mutex> lg { w->jobs_mutex };
+      w->jobs.push_back(std::move(j));
+    }
+    ++queued;
+    /* If nobody is waiting for some work, start another worker if
+       allowed, otherwise let the monitor check for starvation */
+    if (idle == 0 && !(started < concurrency && !stop && start_worker()))
+      notify_monitor();
+    // Take the lock to avoid missing a worker going to sleep
+    { std::lock_guard<std::mutex> lg { wake_mutex }; }
+    wake.notify_one();
+  }
+
+
+  /// Stop the workers once all the jobs have been executed
+  ~executor() {
+    stop = true;
+    { std::lock_guard<std::mutex> lg { wake_mutex }; }
+    wake.notify_all();
+    { std::lock_guard<std::mutex> lg { monitor_mutex }; }
+    monitor_wake.notify_all();
+    if (monitor.joinable())
+      monitor.join();
+    // Since stop is set, no more workers can be started after this
+    std::size_t n;
+    {
+      std::lock_guard<std::mutex> lg { start_mutex };
+      n = started;
+    }
+    for (std::size_t i = 0; i < n; ++i)
+      workers[i]->thread.join();
+  }
+
+private:
+
+  /** Start a new worker
+
+      \return true if a worker has been started
+  */
+  bool start_worker() {
+    std::lock_guard<std::mutex> lg { start_mutex };
+    auto n = started.load();
+    if (n == max_workers || stop)
+      return false;
+    workers[n] = std::make_unique<worker>();
+    // Publish the worker before it can be looked at by the others
+    started.store(n + 1, std::memory_order_release);
+    workers[n]->thread = std::thread { [this, n] { run_worker(n); } };
+    TRISYCL_DUMP_T("Executor started worker " << n);
+    if (n == 0)
+      monitor = std::thread { [this] { run_monitor(); } };
+    return true;
+  }
+
+
+  /// Ask the monitor to check for starvation
+  void notify_monitor() {
+    // Take the lock to avoid missing the monitor going to sleep
+    { std::lock_guard<std::mutex> lg { monitor_mutex }; }
+    monitor_wake.notify_one();
+  }
+
+
+  /// Pop the most recent job of a worker own deque
+  bool pop(std::size_t self, job &j) {
+    auto &w = *workers[self];
+    std::lock_guard<std::mutex> lg { w.jobs_mutex };
+    if (w.jobs.empty())
+      return false;
+    j = std::move(w.jobs.back());
+    w.jobs.pop_back();
+    --queued;
+    return true;
+  }
+
+
+  /// Steal the oldest job from another worker
+  bool steal(std::size_t self, job &j) {
+    auto n = started.load(std::memory_order_acquire);
+    for (std::size_t i = 1; i < n; ++i) {
+      auto &w = *workers[(self + i) % n];
+      std::lock_guard<std::mutex> lg { w.jobs_mutex };
+      if (!w.jobs.empty()) {
+        j = std::move(w.jobs.front());
+        w.jobs.pop_front();
+        --queued;
+        return true;
+      }
+    }
+    return false;
+  }
+
+
+  /// The main loop of a worker
+  void run_worker(std::size_t self) {
+    current_worker = workers[self].get();
+    for (;;) {
+      job j;
+      if (pop(self, j) || steal(self, j)) {
+        /* Some jobs may have been submitted while this worker was
+           idle, so check for starvation now that it is busy */
+        if (queued != 0 && idle == 0)
+          notify_monitor();
+        j();
+        ++completed;
+        continue;
+      }
+      std::unique_lock<std::mutex> ul { wake_mutex };
+      ++idle;
+      wake.wait(ul, [&] { return stop || queued != 0; });
+      --idle;
+      if (stop && queued == 0)
+        return;
+    }
+  }
+
+
+  /// Inject some workers when the jobs do not make progress
+  void run_monitor() {
+    std::unique_lock<std::mutex> ul { monitor_mutex };
+    for (;;) {
+      monitor_wake.wait(ul, [&] {
+          return stop || (queued != 0 && idle == 0);
+        });
+      if (stop)
+        return;
+      auto seen = completed.load();
+      // Back off exponentially with the number of injected workers
+      auto extra = started > concurrency ? started - concurrency : 0;
+      auto delay = starvation_delay * (1 << std::min<std::size_t>(extra, 7));
+      if (monitor_wake.wait_for(ul, delay, [&] { return stop.load(); }))
+        return;
+      if (queued != 0 && idle == 0 && completed == seen) {
+        ul.unlock();
+        start_worker();
+        ul.lock();
+      }
+    }
+  }
+
+};
+
+/// @} End the execution Doxygen group
+
+}
+
+/*
+    # Some Emacs stuff:
+    ### Local Variables:
+    ### ispell-local-dictionary: "american"
+    ### eval: (flyspell-prog-mode)
+    ### End:
+*/
+
+#endif // TRISYCL_SYCL_COMMAND_GROUP_DETAIL_EXECUTOR_HPP
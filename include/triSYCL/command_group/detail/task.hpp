@@ -9,10 +9,17 @@
     License. See LICENSE.TXT for details.
 */
 
+#include <algorithm>
+#include <atomic>
+#include <chrono>
 #include <condition_variable>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <limits>
 #include <memory>
 #include <mutex>
-#include <thread>
+#include <utility>
 #include <vector>
 
 #ifdef TRISYCL_OPENCL
@@ -21,12 +28,16 @@
 
 #include "triSYCL/accessor/detail/accessor_base.hpp"
 #include "triSYCL/buffer/detail/buffer_base.hpp"
+#include "triSYCL/command_group/detail/executor.hpp"
 #include "triSYCL/detail/debug.hpp"
 #include "triSYCL/kernel.hpp"
+#include "triSYCL/parallelism/detail/thread_budget.hpp"
 #include "triSYCL/queue/detail/queue.hpp"
 
 namespace trisycl::detail {
 
+struct event;
+
 /** The abstraction to represent SYCL tasks executing inside command_group
 
     "enable_shared_from_this" allows to access the shared_ptr behind the
@@ -45,6 +56,28 @@ struct task : public std::enable_shared_from_this<task>,
   /// The tasks producing the buffers used by this task
   std::vector<std::shared_ptr<detail::task>> producer_tasks;
 
+  /** The tasks to notify when this task completes
+
+      Protected by \c ready_mutex
+  */
+  std::vector<std::shared_ptr<detail::task>> consumer_tasks;
+
+  /** Number of producers still running, plus 1 while the task is not
+      scheduled yet, so that the task is runnable when it reaches 0 */
+  std::atomic<std::size_t> pending_producers { 1 };
+
+  /// The kernel to run once all the producers have completed
+  std::function<void(void)> kernel_body;
+
+  /** Whether the kernel only starts some asynchronous work which
+      calls complete() at its end, instead of the task completing when
+      the kernel returns */
+  bool completed_by_kernel = false;
+
+  /** Whether the task runs some host code instead of a kernel, which
+      does not take a share of the thread budget */
+  bool host_code = false;
+
   /// Keep track of any prologue to be executed before the kernel
   std::vector<std::function<void(void)>> prologues;
 
@@ -54,6 +87,35 @@ struct task : public std::enable_shared_from_this<task>,
   /// Store if the execution ended, to be notified by task_ready
   bool execution_ended = false;
 
+  /// Whether the task has been scheduled, to be waited for
+  bool scheduled = false;
+
+  /// Whether the kernel has started, for the event status
+  std::atomic<bool> started { false };
+
+  /** The producers of the task when it has been scheduled, for
+      event::get_wait_list() */
+  std::vector<std::weak_ptr<detail::task>> wait_list;
+
+  /** The event tracking this task, if any, to have the same event for
+      a task
+
+      Protected by \c ready_mutex
+  */
+  std::weak_ptr<detail::event> event_implementation;
+
+  /// Whether the profiling time stamps are recorded
+  bool profiled;
+
+  /** The profiling time stamps, in nanoseconds
+
+      They are written before the task completes and are to be read
+      once it has completed.
+  */
+  std::uint64_t submit_time = 0;
+  std::uint64_t start_time = 0;
+  std::uint64_t end_time = 0;
+
   /// To signal when this task is ready
   std::condition_variable ready;
 
@@ -73,59 +135,190 @@ struct task : public std::enable_shared_from_this<task>,
       by the device compiler to its accessor. */
   std::vector<std::weak_ptr<detail::accessor_base>> accessors;
 
+  /** Whether this task is recorded into a command_graph instead of
+      being scheduled */
+  bool recorded;
+
+  /** The buffers used by a recorded task with their write mode, for
+      the command_graph to compute its dependencies */
+  std::vector<std::pair<std::shared_ptr<detail::buffer_base>, bool>>
+  recorded_accesses;
+
 
   /// Create a task from a submitting queue
   task(const std::shared_ptr<detail::queue> &q)
-    : owner_queue { q } {}
+    : profiled { q->profiling }
+    , owner_queue { q }
+    , recorded { q->recording != nullptr } {}
+
+
+  /// Get the current time in nanoseconds for the profiling
+  static std::uint64_t now() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+      std::chrono::steady_clock::now().time_since_epoch()).count();
+  }
+
 
+  /** Add a new task to the task graph and schedule for execution
 
-  /// Add a new task to the task graph and schedule for execution
+      Instead of blocking a thread until the producers complete, the
+      task registers itself to its producers and is submitted to the
+      executor by the last of them to complete.
+  */
   void schedule(std::function<void(void)> f) {
-    /* To keep a copy of the task shared_ptr after the end of the
-       command group, capture it by copy in the following lambda.
-    */
-    auto execution = [f = std::move(f), task = shared_from_this()] {
-      // Wait for the required tasks to be ready
-      task->wait_for_producers();
-      task->prelude();
-      TRISYCL_DUMP_T("Execute the kernel");
-      // Execute the kernel
-      f();
-      task->postlude();
-      // Release the buffers that have been written by this task
-      task->release_buffers();
-      // Notify the waiting tasks that we are done
-      task->notify_consumers();
-      // Notify the queue we are done
-      task->owner_queue->kernel_end();
-      TRISYCL_DUMP_T("Task thread exit");
-    };
+    if (recorded) {
+      // Just keep the kernel for the command_graph to replay it
+      kernel_body = std::move(f);
+      return;
+    }
     /* Notify the queue that there is a kernel submitted to the
        queue. Do not do it in the task contructor so that we can deal
        with command group without kernel and if we put it inside the
-       thread, the queue may have finished before the thread is
+       executor, the queue may have finished before the task is
        scheduled */
     owner_queue->kernel_start();
-    /* \todo it may be implementable with packaged_task that would
-       deal with exceptions in kernels
-    */
+    kernel_body = std::move(f);
+    scheduled = true;
+    if (profiled)
+      submit_time = now();
+    if (owner_queue->in_order)
+      // Just wait for the previous command group of the queue
+      if (auto previous = std::atomic_exchange(&owner_queue->last_task,
+                                               shared_from_this()))
+        producer_tasks.push_back(std::move(previous));
+    // Remember the producers for the event of this task
+    wait_list.assign(producer_tasks.begin(), producer_tasks.end());
 #ifndef TRISYCL_NO_ASYNC
-    /* If in asynchronous execution mode, execute the functor in a new
-       thread */
-    std::thread thread(execution);
-    TRISYCL_DUMP_T("Task thread started");
-    /** Detach the thread since it will synchronize by its own means
-
-        \todo This is an issue if there is an exception in the kernel
-    */
-    thread.detach();
+    // Register to the producers which have not completed yet
+    for (auto &p : producer_tasks)
+      p->add_consumer(shared_from_this());
+    // We can let the producers rest in peace
+    producer_tasks.clear();
+    // Remove the scheduling guard and run if there is nothing to wait for
+    producer_completed();
 #else
     // Just a synchronous execution otherwise
-    execution();
+    wait_for_producers();
+    execute();
 #endif
   }
 
 
+  /** Register a consumer to be notified when this task completes
+
+      If this task has already completed, there is nothing to wait for.
+  */
+  void add_consumer(const std::shared_ptr<detail::task> &consumer) {
+    std::lock_guard<std::mutex> lg { ready_mutex };
+    if (!execution_ended) {
+      ++consumer->pending_producers;
+      consumer_tasks.push_back(consumer);
+    }
+  }
+
+
+  /// Notify that a producer has completed and submit the task if runnable
+  void producer_completed() {
+    if (--pending_producers == 0)
+      /* To keep a copy of the task shared_ptr after the end of the
+         command group, capture it by copy in the following lambda.
+      */
+      executor::instance()->submit([task = shared_from_this()] {
+          task->execute();
+        });
+  }
+
+
+  /// Execute the kernel with its prologue and epilogue
+  void execute() {
+    started = true;
+    if (profiled)
+      start_time = now();
+    prelude();
+    TRISYCL_DUMP_T("Execute the kernel");
+    if (completed_by_kernel) {
+      /* The task may be completed by another thread before the kernel
+         returns, so keep the kernel alive until then. It does not
+         take a share of the thread budget, left to the kernels it
+         starts */
+      auto body = std::move(kernel_body);
+      try {
+        body();
+      } catch (...) {
+        owner_queue->add_async_error(std::current_exception());
+        complete();
+      }
+      return;
+    }
+    /* An exception thrown by the kernel is an asynchronous error of
+       the queue, reported by queue::wait_and_throw(), and the task
+       still completes so that nothing waits for it forever */
+    try {
+      if (host_code)
+        kernel_body();
+      else
+        // Execute the kernel within its share of the thread budget
+        thread_budget::run_kernel(kernel_body);
+    } catch (...) {
+      owner_queue->add_async_error(std::current_exception());
+    }
+    complete();
+  }
+
+
+  /// Run the epilogue and notify the completion of the task
+  void complete() {
+    // Free what the kernel may capture, such as accessors or buffers
+    kernel_body = nullptr;
+    postlude();
+    if (profiled)
+      end_time = now();
+    // Release the buffers that have been written by this task
+    release_buffers();
+    // Notify the waiting tasks that we are done
+    notify_consumers();
+    if (owner_queue->in_order) {
+      /* Forget this task in the queue if no other task has been
+         submitted since, to break the ownership cycle */
+      auto self = shared_from_this();
+      std::atomic_compare_exchange_strong(&owner_queue->last_task, &self,
+                                          std::shared_ptr<detail::task> {});
+    }
+    // Notify the queue we are done
+    owner_queue->kernel_end();
+    TRISYCL_DUMP_T("Task execution exit");
+  }
+
+
+  /** Execute the kernel of a recorded task with its prologue and
+      epilogue, keeping them for the next replay
+
+      An exception thrown by the kernel is reported to the queue \param
+      q replaying the graph.
+  */
+  void execute_recorded(detail::queue &q) {
+    TRISYCL_DUMP_T("Execute the recorded kernel");
+    for (const auto &p : prologues)
+      p();
+    try {
+      thread_budget::run_kernel(kernel_body);
+    } catch (...) {
+      q.add_async_error(std::current_exception());
+    }
+    for (const auto &p : epilogues)
+      p();
+  }
+
+
+  /** Forget the kernel of a recorded task, with what it captures such
+      as accessors owning this task */
+  void forget_recorded() {
+    kernel_body = nullptr;
+    prologues.clear();
+    epilogues.clear();
+  }
+
+
   /// Wait for the required producer tasks to be ready
   void wait_for_producers() {
     TRISYCL_DUMP_T("Task " << this << " waits for the producer tasks");
@@ -148,13 +341,25 @@ struct task : public std::enable_shared_from_this<task>,
   /// Notify the waiting tasks that we are done
   void notify_consumers() {
     TRISYCL_DUMP_T("Notify all the task waiting for this task " << this);
-   {
-     std::unique_lock<std::mutex> ul { ready_mutex };
-     execution_ended = true;
-   }
+    decltype(consumer_tasks) consumers;
+    {
+      std::unique_lock<std::mutex> ul { ready_mutex };
+      execution_ended = true;
+      consumers.swap(consumer_tasks);
+    }
     /* \todo Verify that the memory model with the notify does not
        require some fence or atomic */
     ready.notify_all();
+    // Submit the consumers for which this task was the last producer
+    for (auto &c : consumers)
+      c->producer_completed();
+  }
+
+
+  /// Test whether this task has completed
+  bool is_completed() {
+    std::lock_guard<std::mutex> lg { ready_mutex };
+    return execution_ended;
   }
 
 
@@ -169,38 +374,59 @@ struct task : public std::enable_shared_from_this<task>,
   }
 
 
-  /** Register a buffer to this task
+  /** Register a buffer to this task, accessing the elements [begin,
+      end) of the buffer in linear order, the whole buffer by default
 
       This is how the dependency graph is incrementally built.
   */
   void add_buffer(std::shared_ptr<detail::buffer_base> &buf,
-                  bool is_write_mode) {
+                  bool is_write_mode,
+                  std::size_t begin = 0,
+                  std::size_t end = std::numeric_limits<std::size_t>::max()) {
     TRISYCL_DUMP_T("Add buffer " << buf << " in task " << this);
+    if (recorded) {
+      /* The dependencies are computed by the command_graph on the
+         whole buffers and the buffer is used only when the graph is
+         replayed */
+      recorded_accesses.emplace_back(buf, is_write_mode);
+      return;
+    }
     /* Keep track of the use of the buffer to notify its release at
        the end of the execution */
     buffers_in_use.push_back(buf);
     // To be sure the buffer does not disappear before the kernel can run
     buf->use();
+    /* Wait for the tasks with a conflicting access to the buffer:
+       the latest producer, plus the readers since then when
+       writing. Concurrent readers do not wait for each other.
+
+       If a buffer is accessed in several modes by this task, it may
+       conflict with itself and add_producer avoids waiting for itself.
+
+       The access is recorded even in an in-order queue for the tasks
+       of the other queues using the buffer, but the tasks of the same
+       in-order queue are already ordered by construction. When the
+       buffer is only used by this queue, the access just replaces the
+       previous one in the history
+    */
+    const void *in_order_queue =
+      owner_queue->in_order ? owner_queue.get() : nullptr;
+    for (auto &t : buf->add_access(shared_from_this(), is_write_mode,
+                                   begin, end, in_order_queue))
+      if (!owner_queue->in_order || t->owner_queue != owner_queue)
+        add_producer(std::move(t));
+  }
 
-    std::shared_ptr<detail::task> latest_producer;
-    if (is_write_mode) {
-      /* Set this task as the latest producer of the buffer so that
-         another kernel may wait on this task */
-      latest_producer = buf->set_latest_producer(shared_from_this());
-    }
-    else
-      latest_producer = buf->get_latest_producer();
 
-    /* If the buffer is to be produced by a task, add the task in the
-       producer list to wait on it before running the task core
+  /** Add a task to wait for before running this one
 
-       If a buffer is accessed first in write mode and then in read mode,
-       the task will add itself as a producer and will wait for itself
-       when calling \c wait_for_producers, we avoid this by checking that
-       \c latest_producer is not \c this
-    */
-    if (latest_producer && latest_producer != shared_from_this())
-      producer_tasks.push_back(latest_producer);
+      A task does not wait for itself nor twice for the same task.
+  */
+  void add_producer(std::shared_ptr<detail::task> t) {
+    if (t != shared_from_this()
+        && std::find(producer_tasks.begin(), producer_tasks.end(), t)
+           == producer_tasks.end())
+      producer_tasks.push_back(std::move(t));
   }
 
 
@@ -0,0 +1,80 @@
+#ifndef TRISYCL_SYCL_DETAIL_LOCAL_MEMORY_SLOT_HPP
+#define TRISYCL_SYCL_DETAIL_LOCAL_MEMORY_SLOT_HPP
+
+/** \file Select the local memory used by the work-group executed by
+    the current thread
+
+    This file is distributed under the University of Illinois Open Source
+    License. See LICENSE.TXT for details.
+*/
+
+#include <cstddef>
+#include <utility>
+
+#include "triSYCL/exception.hpp"
+
+namespace trisycl::detail {
+
+/** \addtogroup parallelism
+    @{
+*/
+
+/** Maximum number of work-groups of a kernel executed concurrently
+    with their own local memory
+
+    The engines running the work-groups concurrently limit their number
+    of threads to this.
+*/
+inline constexpr std::size_t max_local_memory_slots = 256;
+
+
+/** The local memory slot of the work-group executed by the current
+    thread
+
+    When several work-groups of a kernel are executed concurrently, each
+    thread running a whole work-group uses a different slot, so each
+    local accessor provides a different memory to each of them. Slot 0
+    is used by default, for example when the work-groups are executed
+    one after the other.
+*/
+inline thread_local std::size_t local_memory_slot = 0;
+
+
+/// Select the local memory slot of the current thread in a scope
+class local_memory_slot_scope {
+
+  std::size_t previous;
+
+public:
+
+  /** \param[in] slot must be less than max_local_memory_slots
+
+      \throw runtime_error otherwise, since there is no local memory
+      for it
+  */
+  local_memory_slot_scope(std::size_t slot) {
+    if (slot >= max_local_memory_slots)
+      throw runtime_error { "Too many threads for the local memory slots" };
+    previous = std::exchange(local_memory_slot, slot);
+  }
+
+
+  ~local_memory_slot_scope() {
+    local_memory_slot = previous;
+  }
+
+};
+
+/// @} End the parallelism Doxygen group
+
+}
+
+/*
+    # Some Emacs stuff:
+    ### Local Variables:
+    ### ispell-local-dictionary: "american"
+    ### eval: (flyspell-prog-mode)
+    ### End:
+*/
+
+#endif // TRISYCL_SYCL_DETAIL_LOCAL_MEMORY_SLOT_HPP
@@ -0,0 +1,224 @@
+#ifndef TRISYCL_SYCL_DETAIL_NUMA_HPP
+#define TRISYCL_SYCL_DETAIL_NUMA_HPP
+
+/** \file The placement of the buffer memory and of the worker threads
+    on the NUMA nodes
+
+    This file is distributed under the University of Illinois Open Source
+    License. See LICENSE.TXT for details.
+*/
+
+#include <atomic>
+#include <climits>
+#include <cstddef>
+#include <vector>
+
+#ifdef __linux__
+#include <linux/mempolicy.h>
+#include <sched.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+#include "triSYCL/buffer/detail/page_allocation.hpp"
+#include "triSYCL/detail/debug.hpp"
+#include "triSYCL/detail/singleton.hpp"
+#include "triSYCL/parallelism/detail/thread_budget.hpp"
+
+namespace trisycl {
+
+/** \addtogroup data Data access and storage in SYCL
+    @{
+*/
+
+/** How the memory of a buffer is placed on the NUMA nodes
+
+    This is a triSYCL extension.
+*/
+enum class numa_policy {
+  /** Each page is placed on the node of the thread touching it first,
+      which is the thread of the parallel loops which will process it
+      with the same static partition */
+  first_touch,
+  /// The pages are distributed round-robin on all the allowed nodes
+  interleave,
+  /// All the pages are placed on a given node
+  bind
+};
+
+/// @} End the data Doxygen group
+
+namespace detail {
+
+/** \addtogroup data Data access and storage in SYCL
+    @{
+*/
+
+/** The NUMA placement of the memory and the pinning of the threads
+
+    The placement only pays off if the threads of the parallel loops
+    stay on the same node, so the threads of the OpenMP teams can be
+    pinned: the thread of a given index in any team of a kernel running
+    alone runs on the same CPU. This way the thread touching a page at
+    initialization and the thread processing it later in a kernel run
+    on the same node, even if they are not the same thread of the
+    process. The kernels running concurrently use the CPUs after the
+    share of the budget of the kernels already running.
+
+    The master thread of a team is never pinned, since it is the
+    thread calling the parallel loop, such as an executor worker
+    running other tasks later or a thread of the application.
+
+    Without NUMA support in the system, everything here does nothing.
+*/
+class numa : public detail::singleton<numa>,
+             public detail::debug<numa> {
+
+  /// Pin the threads of the parallel loops
+  std::atomic<bool> pinning { false };
+
+  /// The CPUs the process is allowed to run on
+  std::vector<int> cpus;
+
+  /// The CPU the current thread is pinned on, -1 if none
+  static inline thread_local int pinned_cpu = -1;
+
+  // Only the singleton can construct it
+  friend detail::singleton<numa>;
+
+  numa() {
+#ifdef __linux__
+    cpu_set_t set;
+    if (!::sched_getaffinity(0, sizeof(set), &set))
+      for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu)
+        if (CPU_ISSET(cpu, &set))
+          cpus.push_back(cpu);
+#endif
+  }
+
+public:
+
+  /// Set whether the threads of the parallel loops are pinned
+  void set_pinning(bool p) {
+    pinning = p;
+  }
+
+
+  /// Test whether the threads of the parallel loops are pinned
+  bool is_pinning() const {
+    return pinning;
+  }
+
+
+  /** Pin the current thread as the thread \param thread of a team of a
+      parallel loop, if the pinning is requested
+
+      The thread 0 is the master thread of the team and is left
+      alone. The system call is done only when the thread moves to
+      another CPU.
+  */
+  static void pin_team_thread(std::size_t thread) {
+    if (thread == 0)
+      return;
+    auto n = instance();
+    if (!n->pinning || n->cpus.empty())
+      return;
+    auto cpu = n->cpus[(thread_budget::team_offset() + thread)
+                       % n->cpus.size()];
+    if (cpu == pinned_cpu)
+      return;
+#ifdef __linux__
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    if (!::sched_setaffinity(0, sizeof(set), &set))
+      pinned_cpu = cpu;
+#endif
+  }
+
+
+  /** Place the pages of \param bytes bytes from \param p, which has to
+      be aligned on a page, according to \param policy
+
+      With numa_policy::bind the memory goes on the node \param node.
+
+      It has to be done before the pages are touched. It is only a
+      hint: the memory is usable anyway if the placement fails, for
+      example on a system without NUMA.
+  */
+  static void place(void *p, std::size_t bytes, numa_policy policy,
+                    int node) {
+#ifdef __linux__
+    constexpr auto bits = sizeof(unsigned long)*CHAR_BIT;
+    unsigned long nodes = 0;
+    int mode;
+    if (policy == numa_policy::interleave) {
+      // Interleave on all the nodes the process is allowed to use
+      if (::syscall(SYS_get_mempolicy, nullptr, &nodes, bits, nullptr,
+                    MPOL_F_MEMS_ALLOWED))
+        return;
+      mode = MPOL_INTERLEAVE;
+    }
+    else if (policy == numa_policy::bind) {
+      if (node < 0 || std::size_t(node) >= bits)
+        return;
+      nodes = 1UL << node;
+      mode = MPOL_BIND;
+    }
+    else
+      // The default policy already places on first touch
+      return;
+    // The kernel expects the number of bits plus 1
+    ::syscall(SYS_mbind, p, bytes, mode, &nodes, bits + 1, 0);
+#endif
+  }
+
+
+  /** Touch the pages of an array of \param count elements of
+      \param element_size bytes from \param p with the threads of a
+      parallel loop on these elements
+
+      Each thread touches the pages starting in the static chunk of
+      elements it owns in the parallel loops, so that the pages are
+      placed on its node.
+  */
+  static void first_touch(void *p, std::size_t count,
+                          std::size_t element_size) {
+#if defined(_OPENMP) && defined(__linux__)
+    const auto page = std::size_t(::sysconf(_SC_PAGESIZE));
+    auto start = static_cast<volatile char *>(p);
+#pragma omp parallel num_threads(thread_budget::team_size())
+    {
+      const std::size_t thread = omp_get_thread_num();
+      pin_team_thread(thread);
+      auto [begin, end] =
+        thread_budget::static_chunk(count, omp_get_num_threads(), thread);
+      // The first page starting in the chunk
+      for (auto b = round_up(begin*element_size, page);
+           b < end*element_size;
+           b += page)
+        start[b] = 0;
+    }
+#endif
+  }
+
+};
+
+/// @} End the data Doxygen group
+
+}
+}
+
+/*
+    # Some Emacs stuff:
+    ### Local Variables:
+    ### ispell-local-dictionary: "american"
+    ### eval: (flyspell-prog-mode)
+    ### End:
+*/
+
+#endif // TRISYCL_SYCL_DETAIL_NUMA_HPP
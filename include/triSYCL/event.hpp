@@ -8,9 +8,12 @@
     This file is distributed under the University of Illinois Open Source
     License. See LICENSE.TXT for details.
 */
+#include <memory>
+
 #include "triSYCL/info/event.hpp"
 #include "triSYCL/event/detail/event.hpp"
 #include "triSYCL/event/detail/host_event.hpp"
+#include "triSYCL/event/detail/task_event.hpp"
 #ifdef TRISYCL_OPENCL
 #include "triSYCL/event/detail/opencl_event.hpp"
 #endif
@@ -24,10 +27,22 @@ class event : public detail::shared_ptr_implementation<event, detail::event> {
   using implementation_t = typename event::shared_ptr_implementation;
 
   friend implementation_t;
+
+  /// Construct an event from its implementation
+  event(const std::shared_ptr<detail::event> &e) : implementation_t { e } {}
+
 public:
 
   event() : implementation_t { detail::host_event::instance() } {}
 
+
+  /** Construct the event of a command group from the task running it
+
+      Note that this is an implementation dependent constructor.
+  */
+  event(const std::shared_ptr<detail::task> &t)
+    : implementation_t { detail::task_event::instance(t) } {}
+
 #ifdef TRISYCL_OPENCL
   /** Construct an event class using the clEvent from OpenCL.
 
@@ -62,9 +77,12 @@ public:
   }
 #endif
 
+  /// Return the events of the commands this event directly waits for
   vector_class<event> get_wait_list() {
-    TRISYCL_UNIMPL;
-    return {};
+    vector_class<event> events;
+    for (auto &e : implementation->get_wait_list())
+      events.push_back(event { e });
+    return events;
   }
 
   /** Wait for the event and the command associated with it to complete.
@@ -74,16 +92,28 @@ public:
     implementation->wait();
   }
 
+  /// Wait for the completion of all the events of a list
   static void wait(const vector_class<event> &eventList) {
-    TRISYCL_UNIMPL;
+    for (auto e : eventList)
+      e.wait();
   }
 
+  /** Wait for the event and report the asynchronous errors
+
+      The exceptions thrown by the kernels are kept by their queue, so
+      all the asynchronous errors of the queue of the command are
+      passed to its async_handler.
+  */
   void wait_and_throw() {
-    TRISYCL_UNIMPL;
+    wait();
+    implementation->throw_asynchronous();
   }
 
+  /** Wait for all the events of a list and report the asynchronous
+      errors */
   static void wait_and_throw(const vector_class<event> &eventList) {
-    TRISYCL_UNIMPL;
+    for (auto e : eventList)
+      e.wait_and_throw();
   }
 
   /// Query the event for information
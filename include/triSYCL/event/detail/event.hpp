@@ -9,6 +9,9 @@
     License. See LICENSE.TXT for details.
 */
 
+#include <memory>
+#include <vector>
+
 namespace trisycl::detail {
 
 struct event : detail::debug<detail::event> {
@@ -30,8 +33,16 @@ public:
 
   virtual cl_uint get_reference_count() const = 0;
 
+  /// Return the events this event directly waits for
+  virtual std::vector<std::shared_ptr<detail::event>> get_wait_list() const {
+    return {};
+  }
+
   virtual void wait() const = 0;
 
+  /// Report the asynchronous errors of the command, if any
+  virtual void throw_asynchronous() const {}
+
   virtual ~event() {}
 };
 
@@ -0,0 +1,136 @@
+#ifndef TRISYCL_SYCL_EVENT_DETAIL_TASK_EVENT_HPP
+#define TRISYCL_SYCL_EVENT_DETAIL_TASK_EVENT_HPP
+
+/** \file The triSYCL event implementation tracking a task
+
+    This file is distributed under the University of Illinois Open Source
+    License. See LICENSE.TXT for details.
+*/
+
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "triSYCL/command_group/detail/task.hpp"
+#include "triSYCL/event/detail/event.hpp"
+#include "triSYCL/exception.hpp"
+
+namespace trisycl::detail {
+
+/// The event of a command group, tracking the task running it
+class task_event : public detail::event {
+  std::shared_ptr<detail::task> t;
+
+public:
+
+  /// Get the event tracking a task, creating it if needed
+  static std::shared_ptr<task_event>
+  instance(const std::shared_ptr<detail::task> &t) {
+    std::lock_guard<std::mutex> lg { t->ready_mutex };
+    auto e =
+      std::static_pointer_cast<task_event>(t->event_implementation.lock());
+    if (!e) {
+      e.reset(new task_event { t });
+      t->event_implementation = e;
+    }
+    return e;
+  }
+
+private:
+
+  /// Only the instance factory can build it
+  task_event(const std::shared_ptr<detail::task> &t) : t { t } {}
+
+
+  /** Wait for the task completion
+
+      \throw invalid_object_error if the task is recorded in a
+      command_graph, since it is never executed by itself
+  */
+  void wait_task() const {
+    if (t->recorded)
+      throw invalid_object_error("Cannot wait for a recorded command group");
+    t->wait();
+  }
+
+public:
+
+#ifdef TRISYCL_OPENCL
+  cl_event get() const override {
+    throw non_cl_error("The task event has no OpenCL event");
+  }
+
+  const boost::compute::event &get_boost_compute() const override {
+    throw non_cl_error("The task event has no underlying Boost Compute event");
+  }
+#endif
+
+  /// Get the task tracked by this event
+  const std::shared_ptr<detail::task> &get_task() const {
+    return t;
+  }
+
+
+  bool is_host() const override {
+    return t->owner_queue->is_host();
+  }
+
+  cl_uint get_reference_count() const override {
+    return 0;
+  }
+
+  info::event_command_status get_command_execution_status() const override {
+    if (t->is_completed())
+      return info::event_command_status::complete;
+    if (t->started)
+      return info::event_command_status::running;
+    return info::event_command_status::submitted;
+  }
+
+  /** Get a profiling time stamp in nanoseconds
+
+      The start and end time stamps wait for the task completion.
+  */
+  cl_ulong get_profiling_info(info::event_profiling param) const override {
+    if (!t->profiled)
+      throw invalid_object_error("The queue has not been constructed with "
+                                 "the enable_profiling property");
+    switch (param) {
+    case info::event_profiling::command_submit:
+      return t->submit_time;
+    case info::event_profiling::command_start:
+      wait_task();
+      return t->start_time;
+    case info::event_profiling::command_end:
+      wait_task();
+      return t->end_time;
+    }
+    return 0;
+  }
+
+  /** The producers of the task still alive
+
+      The producers already released have completed anyway.
+  */
+  std::vector<std::shared_ptr<detail::event>> get_wait_list() const override {
+    std::vector<std::shared_ptr<detail::event>> events;
+    for (auto &p : t->wait_list)
+      if (auto producer = p.lock())
+        events.push_back(instance(producer));
+    return events;
+  }
+
+  void wait() const override {
+    wait_task();
+  }
+
+  /** The exceptions of the kernels are kept by the queue running the
+      task, so report them all */
+  void throw_asynchronous() const override {
+    t->owner_queue->throw_asynchronous();
+  }
+};
+
+}
+
+#endif // TRISYCL_SYCL_EVENT_DETAIL_TASK_EVENT_HPP
@@ -175,6 +175,21 @@ public:
 
 
   /** Loop on the work-items inside a work-group
+
+      The kernel functor type is kept up to the work-item loop, so
+      that the compiler can inline and vectorize the work-item body.
+   */
+  template <typename ParallelForFunctor>
+  void parallel_for_work_item(ParallelForFunctor f) const {
+    detail::parallel_for_workitem_in_group(*this, f);
+  }
+
+
+  /** Loop on the work-items inside a work-group with a type-erased
+      kernel
+
+      This is used when the kernel is already a std::function, to
+      avoid instantiating the work-item loop for each kernel type
    */
   void parallel_for_work_item(std::function<void(h_item<dimensionality>)> f)
     const {
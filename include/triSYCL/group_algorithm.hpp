@@ -0,0 +1,285 @@
+#ifndef TRISYCL_SYCL_GROUP_ALGORITHM_HPP
+#define TRISYCL_SYCL_GROUP_ALGORITHM_HPP
+
+/** \file The collective algorithms of the work-items of a work-group
+    or a sub-group
+
+    This is inspired by the SYCL 2020 group algorithm interface. All the
+    work-items of a work-group of a nd_range kernel have to call the
+    same algorithms in the same order.
+
+    Since nd_item::get_group() returns an id<> in this implementation,
+    the work-group can also be designated directly by an nd_item.
+
+    A sub-group collective only synchronizes the work-items of the
+    sub-group, whose leader computes the results in one pass over the
+    sub_group::max_size values at most, which the compiler can map onto
+    vector registers. So all the work-items of a sub-group have to
+    call the same algorithms in the same order, but the other
+    sub-groups can call different ones.
+
+    This file is distributed under the University of Illinois Open Source
+    License. See LICENSE.TXT for details.
+*/
+
+#include <cstddef>
+#include <type_traits>
+
+#include "triSYCL/detail/linear_id.hpp"
+#include "triSYCL/group.hpp"
+#include "triSYCL/id.hpp"
+#include "triSYCL/nd_item.hpp"
+#include "triSYCL/parallelism/detail/work_group_collective.hpp"
+#include "triSYCL/reduction.hpp"
+#include "triSYCL/sub_group.hpp"
+
+namespace trisycl {
+
+/** \addtogroup parallelism
+    @{
+*/
+
+namespace detail {
+
+/** Enable a collective algorithm returning T for a work-group
+    designated either by a group or by one of its nd_item, or for a
+    sub-group */
+template <typename Group, typename T>
+using enable_if_group_t =
+  std::enable_if_t<std::is_same_v<Group, group<Group::dimensionality>>
+                   || std::is_same_v<Group, nd_item<Group::dimensionality>>
+                   || std::is_same_v<Group, sub_group>,
+                   T>;
+
+
+/** Exchange a value between the work-items of a group
+
+    \param[in] compute is called as compute(values, results, n) for
+    each group of n work-items, with the values and the results of the
+    group indexed by the local linear id in the group
+*/
+template <typename Group, typename T, typename Compute>
+T group_exchange(const Group &g, const T &x, Compute compute) {
+  if constexpr (std::is_same_v<Group, sub_group>)
+    return work_group_collective::exchange(g, x,
+      [&] (const T *values, T *results) {
+        compute(values, results, g.get_local_linear_range());
+      });
+  else {
+    const auto size = g.get_local_range().size();
+    auto whole = [&] (const T *values, T *results) {
+      compute(values, results, size);
+    };
+    if constexpr (std::is_same_v<Group, group<Group::dimensionality>>)
+      // Only the engine knows which work-item is calling
+      return work_group_collective::exchange(g.get_local_range(), x, whole);
+    else
+      return work_group_collective::exchange(size, g.get_local_linear_id(),
+                                             x, whole);
+  }
+}
+
+}
+
+
+/** Get the value of a work-item in all the work-items of a group
+
+    \param[in] local_linear_id is the local linear id in the group of
+    the work-item providing the value
+*/
+template <typename Group, typename T>
+detail::enable_if_group_t<Group, T>
+group_broadcast(const Group &g,
+                const T &x,
+                std::size_t local_linear_id = 0) {
+  return detail::group_exchange(g, x,
+    [&] (const T *values, T *results, std::size_t n) {
+      for (std::size_t i = 0; i != n; ++i)
+        results[i] = values[local_linear_id];
+    });
+}
+
+
+/** Get the value of a work-item in all the work-items of a group
+
+    \param[in] local_id is the local id in the group of the work-item
+    providing the value
+*/
+template <typename Group, typename T>
+detail::enable_if_group_t<Group, T>
+group_broadcast(const Group &g,
+                const T &x,
+                const id<Group::dimensionality> &local_id) {
+  return group_broadcast(g, x, detail::linear_id(g.get_local_range(),
+                                                 local_id));
+}
+
+
+/// Combine the values of all the work-items of a group
+template <typename Group, typename T, typename BinaryOperation>
+detail::enable_if_group_t<Group, T>
+reduce_over_group(const Group &g,
+                  const T &x,
+                  BinaryOperation combiner) {
+  return detail::group_exchange(g, x,
+    [&] (const T *values, T *results, std::size_t n) {
+      T result = values[0];
+      for (std::size_t i = 1; i != n; ++i)
+        result = combiner(result, values[i]);
+      for (std::size_t i = 0; i != n; ++i)
+        results[i] = result;
+    });
+}
+
+
+/** Combine an initial value with the values of all the work-items of a
+    group */
+template <typename Group, typename V, typename T, typename BinaryOperation>
+detail::enable_if_group_t<Group, T>
+reduce_over_group(const Group &g,
+                  const V &x,
+                  const T &init,
+                  BinaryOperation combiner) {
+  return combiner(init, reduce_over_group(g, static_cast<T>(x), combiner));
+}
+
+
+/** Combine an initial value with the values of the work-items of a
+    group up to the calling one included, in local linear id order */
+template <typename Group, typename V, typename T, typename BinaryOperation>
+detail::enable_if_group_t<Group, T>
+inclusive_scan_over_group(const Group &g,
+                          const V &x,
+                          BinaryOperation combiner,
+                          const T &init) {
+  return detail::group_exchange(g, static_cast<T>(x),
+    [&] (const T *values, T *results, std::size_t n) {
+      T partial = init;
+      for (std::size_t i = 0; i != n; ++i)
+        results[i] = partial = combiner(partial, values[i]);
+    });
+}
+
+
+/** Combine the values of the work-items of a group up to the calling
+    one included, in local linear id order */
+template <typename Group, typename T, typename BinaryOperation>
+detail::enable_if_group_t<Group, T>
+inclusive_scan_over_group(const Group &g,
+                          const T &x,
+                          BinaryOperation combiner) {
+  return detail::group_exchange(g, x,
+    [&] (const T *values, T *results, std::size_t n) {
+      T partial = results[0] = values[0];
+      for (std::size_t i = 1; i != n; ++i)
+        results[i] = partial = combiner(partial, values[i]);
+    });
+}
+
+
+/** Combine an initial value with the values of the work-items of a
+    group before the calling one, in local linear id order */
+template <typename Group, typename V, typename T, typename BinaryOperation>
+detail::enable_if_group_t<Group, T>
+exclusive_scan_over_group(const Group &g,
+                          const V &x,
+                          const T &init,
+                          BinaryOperation combiner) {
+  return detail::group_exchange(g, static_cast<T>(x),
+    [&] (const T *values, T *results, std::size_t n) {
+      T partial = init;
+      for (std::size_t i = 0; i != n; ++i) {
+        results[i] = partial;
+        partial = combiner(partial, values[i]);
+      }
+    });
+}
+
+
+/** Combine the values of the work-items of a group before the calling
+    one, in local linear id order, starting from the identity of the
+    combiner */
+template <typename Group, typename T, typename BinaryOperation>
+detail::enable_if_group_t<Group, T>
+exclusive_scan_over_group(const Group &g,
+                          const T &x,
+                          BinaryOperation combiner) {
+  static_assert(has_known_identity_v<BinaryOperation, T>,
+                "The initial value has to be given for this combiner");
+  return exclusive_scan_over_group(g, x,
+                                   known_identity<BinaryOperation, T>::value,
+                                   combiner);
+}
+
+
+namespace detail {
+
+/** Get in each work-item of a sub-group the value of the work-item
+    source(i, n) of the sub-group, with i the calling work-item and n
+    the sub-group size
+
+    A work-item whose source is out of the sub-group keeps its value.
+*/
+template <typename T, typename Source>
+T sub_group_permute(const sub_group &sg, const T &x, Source source) {
+  return group_exchange(sg, x,
+    [&] (const T *values, T *results, std::size_t n) {
+#ifdef _OPENMP
+#pragma omp simd
+#endif
+      for (std::size_t i = 0; i < n; ++i) {
+        const std::size_t s = source(i, n);
+        results[i] = values[s < n ? s : i];
+      }
+    });
+}
+
+}
+
+
+/// Get the value of the work-item local_linear_id of the sub-group
+template <typename T>
+T select_from_group(const sub_group &sg,
+                    const T &x,
+                    std::size_t local_linear_id) {
+  return detail::sub_group_permute(sg, x,
+    [=] (std::size_t, std::size_t) { return local_linear_id; });
+}
+
+
+/// Get the value of the work-item delta positions after in the sub-group
+template <typename T>
+T shift_group_left(const sub_group &sg, const T &x, std::size_t delta = 1) {
+  return detail::sub_group_permute(sg, x,
+    [=] (std::size_t i, std::size_t) { return i + delta; });
+}
+
+
+/// Get the value of the work-item delta positions before in the sub-group
+template <typename T>
+T shift_group_right(const sub_group &sg, const T &x, std::size_t delta = 1) {
+  return detail::sub_group_permute(sg, x,
+    [=] (std::size_t i, std::size_t n) { return i >= delta ? i - delta : n; });
+}
+
+
+/// Get the value of the work-item whose local id is the own one xor mask
+template <typename T>
+T permute_group_by_xor(const sub_group &sg, const T &x, std::size_t mask) {
+  return detail::sub_group_permute(sg, x,
+    [=] (std::size_t i, std::size_t) { return i ^ mask; });
+}
+
+/// @} End the parallelism Doxygen group
+
+}
+
+/*
+    # Some Emacs stuff:
+    ### Local Variables:
+    ### ispell-local-dictionary: "american"
+    ### eval: (flyspell-prog-mode)
+    ### End:
+*/
+
+#endif // TRISYCL_SYCL_GROUP_ALGORITHM_HPP
@@ -13,7 +13,7 @@
 
 #include "triSYCL/access.hpp"
 #include "triSYCL/detail/linear_id.hpp"
-#include "triSYCL/detail/unimplemented.hpp"
+#include "triSYCL/exception.hpp"
 #include "triSYCL/id.hpp"
 #include "triSYCL/item.hpp"
 #include "triSYCL/nd_range.hpp"
@@ -206,17 +206,20 @@ public:
       In addition, the barrier performs a fence operation ensuring that all
       memory accesses in the specified address space issued before the
       barrier complete before those issued after the barrier
+
+      \throw feature_not_supported since the work-items of a
+      parallel_for_work_item are executed as a loop by the thread
+      running the work-group, so they cannot wait for each other. Use
+      another parallel_for_work_item instead, since there is an
+      implicit barrier between them. As any exception thrown by a
+      kernel, it reaches the async_handler of the queue through
+      queue::wait_and_throw()
   */
   void barrier(access::fence_space flag =
                access::fence_space::global_and_local) const {
-#if defined(_OPENMP) && !defined(TRISYCL_NO_BARRIER)
-    /* Use OpenMP barrier in the implementation with 1 OpenMP thread per
-       work-item of the work-group */
-#pragma omp barrier
-#else
-    // \todo To be implemented efficiently otherwise
-    TRISYCL_UNIMPL;
-#endif
+    throw feature_not_supported {
+      "h_item::barrier() is not supported, split the "
+      "parallel_for_work_item instead" };
   }
 
 
@@ -22,11 +22,14 @@
 #include "triSYCL/command_group/detail/task.hpp"
 #include "triSYCL/detail/instantiate_kernel.hpp"
 #include "triSYCL/detail/unimplemented.hpp"
+#include "triSYCL/event.hpp"
 #include "triSYCL/exception.hpp"
 #include "triSYCL/kernel.hpp"
 #include "triSYCL/opencl_types.hpp"
 #include "triSYCL/parallelism.hpp"
+#include "triSYCL/property/kernel.hpp"
 #include "triSYCL/queue/detail/queue.hpp"
+#include "triSYCL/reduction.hpp"
 
 namespace trisycl {
 
@@ -66,6 +69,36 @@ public:
   }
 
 
+  /** Make this command group wait for the command of an event
+
+      This orders some command groups which do not share any buffer,
+      for example when they communicate through pipes.
+
+      \throw invalid_object_error if the event comes from a recorded
+      submission and this command group is not recorded, since the
+      recorded command groups are never executed by themselves
+  */
+  void depends_on(event e) {
+    if (auto te = std::dynamic_pointer_cast<detail::task_event>(
+          e.implementation)) {
+      if (te->get_task()->recorded && !task->recorded)
+        throw invalid_object_error("Only a recorded command group can "
+                                   "depend on a recorded command group");
+      task->add_producer(te->get_task());
+    }
+    else
+      // Wait for the other kinds of events just before the kernel
+      task->add_prelude([=] () mutable { e.wait(); });
+  }
+
+
+  /// Make this command group wait for the commands of some events
+  void depends_on(const vector_class<event> &events) {
+    for (const auto &e : events)
+      depends_on(e);
+  }
+
+
 #ifdef TRISYCL_OPENCL
   /** Set accessor kernel arg for an OpenCL kernel which is used through the
       SYCL/OpenCL interop interface
@@ -234,6 +267,31 @@ public:
   }
 
 
+  /** Run some host code as a command of the task graph
+
+      The host code waits for the command groups producing the buffers
+      it accesses through the accessors of this command group and the
+      explicit dependencies, like a kernel, so it can do some I/O or
+      communications while unrelated kernels are running.
+
+      This is from SYCL 2020, without the interop_handle.
+
+      \throw feature_not_supported on a device queue, since the
+      accessors of the command group would keep the data on the device
+      instead of the host
+  */
+  template <typename HostFunctor>
+  void host_task(HostFunctor f) {
+    TRISYCL_DUMP_T("host_task &f = " << (void *) &f);
+    if (!task->owner_queue->is_host())
+      throw feature_not_supported("host_task is only supported on a host "
+                                  "queue");
+    // Some host I/O does not reduce the teams of the running kernels
+    task->host_code = true;
+    task->schedule([=] () mutable { f(); });
+  }
+
+
   /** SYCL parallel_for launches a data parallel computation with
       parallelism specified at launch time by a range<>
 
@@ -274,8 +332,10 @@ public:
             typename ParallelForFunctor>                                \
   void parallel_for(range<N> global_size,                               \
                     ParallelForFunctor f) {                             \
-    schedule_kernel<KernelName>([=] {                                   \
-        detail::parallel_for(global_size, f);                           \
+    /* Use the iteration order of the queue */                          \
+    schedule_kernel<KernelName>([=, policy =                            \
+                                 task->get_queue()->range_iteration] {  \
+        detail::parallel_for_policy(global_size, policy, f);            \
      });                                                                \
   }
 #endif
@@ -285,6 +345,71 @@ public:
   TRISYCL_parallel_for_functor_GLOBAL(3)
 
 
+  /** Kernel invocation method of a kernel defined as a lambda or
+      functor, for the specified range and with a reduction
+
+      The kernel is called with an id or an item and a reference to a
+      reducer to combine its contribution into. Each thread of the
+      host accumulates into its own reducer without synchronization
+      and the partial results are combined at the end.
+
+      \param global_size is the full size of the range<>
+
+      \param red is the reduction created by trisycl::reduction()
+
+      \param f is the kernel functor to execute
+  */
+#define TRISYCL_parallel_for_functor_REDUCTION(N)                      \
+  template <typename KernelName = std::nullptr_t,                      \
+            typename Target,                                           \
+            typename T,                                                \
+            typename BinaryOperation,                                  \
+            typename ParallelForFunctor>                               \
+  void parallel_for(range<N> global_size,                              \
+                    detail::reduction<Target, T, BinaryOperation> red, \
+                    ParallelForFunctor f) {                            \
+    schedule_kernel<KernelName>([=] {                                  \
+        detail::parallel_for_reduce(global_size, red, f);              \
+      });                                                              \
+  }
+
+  TRISYCL_parallel_for_functor_REDUCTION(1)
+  TRISYCL_parallel_for_functor_REDUCTION(2)
+  TRISYCL_parallel_for_functor_REDUCTION(3)
+
+
+  /** Kernel invocation method of a kernel defined as a lambda or
+      functor, for the specified range iterated as changed by a
+      property such as property::kernel::tiled_iteration or
+      property::kernel::partitioner
+
+      This is a triSYCL extension.
+
+      \param global_size is the full size of the range<>
+
+      \param p is the iteration property, overriding its part of the
+      iteration policy of the queue
+
+      \param f is the kernel functor to execute
+  */
+#define TRISYCL_parallel_for_functor_ITERATION(N)                       \
+  template <typename KernelName = std::nullptr_t,                       \
+            typename ParallelForFunctor>                                \
+  void parallel_for(range<N> global_size,                               \
+                    const property::kernel::iteration_property &p,      \
+                    ParallelForFunctor f) {                             \
+    auto policy = task->get_queue()->range_iteration;                   \
+    p.apply(policy);                                                    \
+    schedule_kernel<KernelName>([=] {                                   \
+        detail::parallel_for_policy(global_size, policy, f);            \
+      });                                                               \
+  }
+
+  TRISYCL_parallel_for_functor_ITERATION(1)
+  TRISYCL_parallel_for_functor_ITERATION(2)
+  TRISYCL_parallel_for_functor_ITERATION(3)
+
+
   /** Kernel invocation method of a kernel defined as a lambda or functor,
       for the specified range and offset and given an id or item for
       indexing in the indexing space defined by range
@@ -355,6 +480,61 @@ public:
   }
 
 
+  /** Kernel invocation method of a lambda or functor for the specified
+      nd_range, asserting that the kernel does not use any barrier
+
+      The work-groups are executed in parallel, each one as a loop on
+      its work-items, which is much faster than running a thread per
+      work-item on the host. Calling nd_item::barrier() in such a
+      kernel is invalid.
+
+      This is a triSYCL extension.
+
+      \param r defines the iteration space with the work-group layout and
+      offset
+
+      \param f is the kernel functor to execute
+  */
+  template <typename KernelName = std::nullptr_t,
+            int Dimensions,
+            typename ParallelForFunctor>
+  void parallel_for(nd_range<Dimensions> r,
+                    property::kernel::no_barrier,
+                    ParallelForFunctor f) {
+    schedule_kernel<KernelName>([=] {
+        detail::parallel_for_no_barrier(r, f);
+      });
+  }
+
+
+  /** Kernel invocation method of a lambda or functor for the specified
+      nd_range with a reduction
+
+      The kernel is called with an nd_item and a reference to a
+      reducer to combine its contribution into.
+
+      \param r defines the iteration space with the work-group layout and
+      offset
+
+      \param red is the reduction created by trisycl::reduction()
+
+      \param f is the kernel functor to execute
+  */
+  template <typename KernelName = std::nullptr_t,
+            int Dimensions,
+            typename Target,
+            typename T,
+            typename BinaryOperation,
+            typename ParallelForFunctor>
+  void parallel_for(nd_range<Dimensions> r,
+                    detail::reduction<Target, T, BinaryOperation> red,
+                    ParallelForFunctor f) {
+    schedule_kernel<KernelName>([=] {
+        detail::parallel_for_reduce(r, red, f);
+      });
+  }
+
+
   /** Hierarchical kernel invocation method of a kernel defined as a
       lambda encoding the body of each work-group to launch
 
@@ -504,8 +684,10 @@ namespace detail {
 static std::shared_ptr<detail::task>
 add_buffer_to_task(handler *command_group_handler,
                    std::shared_ptr<detail::buffer_base> b,
-                   bool is_write_mode) {
-  command_group_handler->task->add_buffer(b, is_write_mode);
+                   bool is_write_mode,
+                   std::size_t begin,
+                   std::size_t end) {
+  command_group_handler->task->add_buffer(b, is_write_mode, begin, end);
   return command_group_handler->task;
 }
 
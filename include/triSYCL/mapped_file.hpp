@@ -0,0 +1,87 @@
+#ifndef TRISYCL_SYCL_MAPPED_FILE_HPP
+#define TRISYCL_SYCL_MAPPED_FILE_HPP
+
+/** \file The description of a file used as the storage of a buffer
+
+    This file is distributed under the University of Illinois Open Source
+    License. See LICENSE.TXT for details.
+*/
+
+#include <cstddef>
+#include <string>
+#include <utility>
+
+namespace trisycl {
+
+/** \addtogroup data Data access and storage in SYCL
+    @{
+*/
+
+/** A file to be mapped in memory as the storage of a buffer
+
+    The pages of the file are only read when they are accessed, so a
+    buffer can be larger than the memory and only the parts used by
+    the kernels are loaded.
+
+    This is a triSYCL extension.
+*/
+class mapped_file {
+
+public:
+
+  /// How the file is mapped
+  enum class mode {
+    /** The file is only read. If an accessor writes to the buffer,
+        the data are copied first, as with a buffer built from const
+        host data */
+    read_only,
+    /** The buffer can be written but the file is never modified:
+        only the pages written are copied in memory */
+    read_write_private,
+    /** The writes to the buffer go to the file, which is synchronized
+        on the buffer destruction. The file is created or extended if
+        it is too small for the buffer */
+    read_write_shared
+  };
+
+private:
+
+  std::string path;
+
+  mode file_mode;
+
+  /// The position in bytes of the buffer data in the file
+  std::size_t offset;
+
+public:
+
+  mapped_file(std::string path,
+              mode file_mode = mode::read_only,
+              std::size_t offset = 0)
+    : path { std::move(path) }, file_mode { file_mode }, offset { offset }
+  {}
+
+
+  const std::string &get_path() const { return path; }
+
+
+  mode get_mode() const { return file_mode; }
+
+
+  std::size_t get_offset() const { return offset; }
+
+};
+
+/// @} End the data Doxygen group
+
+}
+
+/*
+    # Some Emacs stuff:
+    ### Local Variables:
+    ### ispell-local-dictionary: "american"
+    ### eval: (flyspell-prog-mode)
+    ### End:
+*/
+
+#endif // TRISYCL_SYCL_MAPPED_FILE_HPP
@@ -18,6 +18,11 @@
 #include "triSYCL/item.hpp"
 #include "triSYCL/nd_range.hpp"
 #include "triSYCL/range.hpp"
+#include "triSYCL/sub_group.hpp"
+
+#ifdef TRISYCL_FIBER_BARRIER
+#include "triSYCL/parallelism/detail/fiber.hpp"
+#endif
 
 namespace trisycl {
 
@@ -122,6 +127,12 @@ public:
   }
 
 
+  /// Return the sub-group of the current work-item
+  sub_group get_sub_group() const {
+    return { get_local_range().size(), get_local_linear_id() };
+  }
+
+
   /** Return the constituent group representing the work-group's
       position within the overall nd_range
   */
@@ -202,7 +213,10 @@ public:
   */
   void barrier(access::fence_space flag =
                access::fence_space::global_and_local) const {
-#if defined(_OPENMP) && !defined(TRISYCL_NO_BARRIER)
+#if defined(TRISYCL_FIBER_BARRIER) && !defined(TRISYCL_NO_BARRIER)
+    // The work-items are fibers, so just switch to the other ones
+    detail::work_group_fibers::barrier();
+#elif defined(_OPENMP) && !defined(TRISYCL_NO_BARRIER)
     /* Use OpenMP barrier in the implementation with 1 OpenMP thread per
        work-item of the work-group */
 #pragma omp barrier
@@ -0,0 +1,278 @@
+#ifndef TRISYCL_SYCL_PARALLELISM_DETAIL_FIBER_HPP
+#define TRISYCL_SYCL_PARALLELISM_DETAIL_FIBER_HPP
+
+/** \file
+
+    Execute the work-items of a work-group as fibers on the current
+    thread, so that the barriers are just cooperative context switches
+
+    This is used when TRISYCL_FIBER_BARRIER is defined and requires
+    linking with the Boost.Context library.
+
+    This file is distributed under the University of Illinois Open Source
+    License. See LICENSE.TXT for details.
+*/
+
+#include <atomic>
+#include <cstddef>
+#include <exception>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include <boost/context/fiber.hpp>
+#include <boost/context/fixedsize_stack.hpp>
+
+#include "triSYCL/exception.hpp"
+
+/** The stack size of a work-item fiber
+
+    It can be increased for kernels with large private arrays.
+*/
+#ifndef TRISYCL_FIBER_STACK_SIZE
+#define TRISYCL_FIBER_STACK_SIZE (64*1024)
+#endif
+
+/** \addtogroup parallelism
+    @{
+*/
+
+namespace trisycl::detail {
+
+/** A stack allocator recycling the fiber stacks of the current thread
+
+    Since a fiber is created for each work-item of each work-group,
+    keep the stacks to avoid a mmap()/munmap() pair per work-item. A
+    fiber never migrates to another thread, so its stack is always
+    given back to the thread which has allocated it.
+*/
+class fiber_stack_pool {
+
+  /// The stacks not in use by the current thread
+  struct free_list {
+    boost::context::fixedsize_stack allocator { TRISYCL_FIBER_STACK_SIZE };
+    std::vector<boost::context::stack_context> stacks;
+
+    ~free_list() {
+      for (auto &s : stacks)
+        allocator.deallocate(s);
+    }
+  };
+
+  static free_list &stacks() {
+    static thread_local free_list fl;
+    return fl;
+  }
+
+public:
+
+  boost::context::stack_context allocate() {
+    auto &fl = stacks();
+    if (fl.stacks.empty())
+      return fl.allocator.allocate();
+    auto s = fl.stacks.back();
+    fl.stacks.pop_back();
+    return s;
+  }
+
+
+  void deallocate(boost::context::stack_context &s) noexcept {
+    try {
+      stacks().stacks.push_back(s);
+    } catch (...) {
+      stacks().allocator.deallocate(s);
+    }
+  }
+
+};
+
+
+/** Run the work-items of a work-group as fibers on the current thread
+
+    The work-items are resumed in round-robin by the current thread.
+    Each round lasts until every work-item has switched back to the
+    scheduler, either because it waits for some other work-items or
+    because it has ended, so a barrier is just a counter and a switch
+    back to the scheduler, without any OS thread per work-item nor
+    any synchronization.
+
+    A work-item can also wait for only some of the others, as the
+    work-items of a sub-group. If during a round no work-item can make
+    progress, they never will, so the waiting work-items throw instead
+    of looping forever.
+
+    Since a thread can run several work-groups one after the other
+    without blocking, the work-groups can be distributed on as many
+    threads as there are cores without oversubscription.
+*/
+class work_group_fibers {
+
+  /// The work-group fibers run by the current thread, if any
+  static inline thread_local work_group_fibers *current = nullptr;
+
+  /// The scheduler context to switch to from the running work-item
+  boost::context::fiber scheduler;
+
+  /// The first exception thrown by a work-item
+  std::exception_ptr exception;
+
+  /// The rank of the work-item running, in the order of the rounds
+  std::size_t running = 0;
+
+  /// Number of work-items which have not ended
+  std::size_t alive = 0;
+
+  /// Number of work-items waiting at the current work-group barrier
+  std::size_t arrived = 0;
+
+  /// Incremented each time the work-items are released from a barrier
+  std::size_t generation = 0;
+
+  /// Whether the running work-item has just waited again in vain
+  bool stalled = false;
+
+  /// Whether no work-item can progress anymore
+  bool deadlocked = false;
+
+  work_group_fibers() = default;
+
+
+  /// Release the work-items at the barrier if all the alive ones are there
+  void release_if_all_arrived() {
+    if (arrived != 0 && arrived == alive) {
+      arrived = 0;
+      ++generation;
+    }
+  }
+
+
+  /// Switch back to the scheduler until \param ready returns true
+  template <typename Ready>
+  void wait(Ready ready) {
+    for (bool again = false; !ready(); again = true) {
+      if (deadlocked)
+        throw kernel_error {
+          "The work-items of a work-group wait for each other forever, "
+          "since they do not call the same barriers or collectives" };
+      stalled = again;
+      scheduler = std::move(scheduler).resume();
+    }
+  }
+
+public:
+
+  /** Execute work_item(i) for i in [0, size) as fibers
+
+      \param[in] size is the number of work-items in the work-group
+
+      \param[in] work_item is called with the linear id of the work-item
+  */
+  template <typename WorkItem>
+  static void run(std::size_t size, WorkItem &work_item) {
+    work_group_fibers self;
+    self.alive = size;
+    auto previous = std::exchange(current, &self);
+    std::vector<boost::context::fiber> fibers;
+    fibers.reserve(size);
+    for (std::size_t i = 0; i != size; ++i)
+      fibers.emplace_back(std::allocator_arg, fiber_stack_pool {},
+                          [&self, &work_item, i]
+                          (boost::context::fiber &&scheduler) {
+          self.scheduler = std::move(scheduler);
+          try {
+            work_item(i);
+          } catch (...) {
+            if (!self.exception)
+              self.exception = std::current_exception();
+          }
+          return std::move(self.scheduler);
+        });
+    // Execute the rounds until all the work-items end
+    while (self.alive != 0) {
+      bool progress = false;
+      for (std::size_t i = 0; i != size; ++i)
+        if (auto &f = fibers[i]) {
+          self.running = i;
+          self.stalled = false;
+          // The fiber is empty again once the work-item has ended
+          f = std::move(f).resume();
+          if (!f) {
+            --self.alive;
+            // The work-items still alive may all be at a barrier now
+            self.release_if_all_arrived();
+            progress = true;
+          }
+          else if (!self.stalled)
+            progress = true;
+        }
+      // Make the waiting work-items throw during the next round
+      if (!progress)
+        self.deadlocked = true;
+    }
+    current = previous;
+    if (self.exception)
+      std::rethrow_exception(self.exception);
+  }
+
+
+  /** Get the rank of the work-item running in the current thread
+
+      It is only valid from a work-item run by run()
+  */
+  static std::size_t current_work_item() {
+    return current->running;
+  }
+
+
+  /** Wait for the other work-items of the work-group by switching
+      back to the scheduler
+
+      It is only valid from a work-item run by run()
+
+      \throw feature_not_supported if not executed as a fiber, such as
+      in a no_barrier kernel, since there is no way to wait for the
+      others; the engine running the kernel passes it on to the
+      queue, which reports it at queue::wait_and_throw()
+  */
+  static void barrier() {
+    if (!current)
+      throw feature_not_supported {
+        "Barrier in a work-item not executed as a fiber" };
+    /* Use a local copy of the pointer since the thread-local
+       variable is changed by the other work-groups run by the same
+       thread while this fiber is suspended */
+    auto self = current;
+    const auto g = self->generation;
+    ++self->arrived;
+    self->release_if_all_arrived();
+    self->wait([&] { return self->generation != g; });
+  }
+
+
+  /** Wait while \param value is equal to \param old, the value being
+      changed by another work-item of the work-group
+
+      It is only valid from a work-item run by run()
+  */
+  static void wait_while_equal(const std::atomic<std::size_t> &value,
+                               std::size_t old) {
+    current->wait([&] {
+        return value.load(std::memory_order_relaxed) != old;
+      });
+  }
+
+};
+
+/// @} End the parallelism Doxygen group
+
+}
+
+/*
+    # Some Emacs stuff:
+    ### Local Variables:
+    ### ispell-local-dictionary: "american"
+    ### eval: (flyspell-prog-mode)
+    ### End:
+*/
+
+#endif // TRISYCL_SYCL_PARALLELISM_DETAIL_FIBER_HPP
@@ -0,0 +1,69 @@
+#ifndef TRISYCL_SYCL_PARALLELISM_DETAIL_FIRST_EXCEPTION_HPP
+#define TRISYCL_SYCL_PARALLELISM_DETAIL_FIRST_EXCEPTION_HPP
+
+/** \file The first exception thrown by the threads of a parallel region
+
+    This file is distributed under the University of Illinois Open Source
+    License. See LICENSE.TXT for details.
+*/
+
+#include <exception>
+#include <mutex>
+
+/** \addtogroup parallelism
+    @{
+*/
+
+namespace trisycl::detail {
+
+/** Keep the first exception thrown by the threads of a parallel region
+
+    An exception cannot escape an OpenMP parallel region or an
+    iteration of a worksharing loop without terminating the program,
+    so the code run by the threads is wrapped with run() and the first
+    exception is rethrown by the thread which started the region, once
+    it has ended.
+*/
+class first_exception {
+
+  std::exception_ptr exception;
+
+  /// To protect exception from the threads throwing at the same time
+  std::mutex exception_mutex;
+
+public:
+
+  /// Run \param f, keeping its exception if it is the first one
+  template <typename F>
+  void run(F &&f) noexcept {
+    try {
+      f();
+    } catch (...) {
+      std::lock_guard<std::mutex> lg { exception_mutex };
+      if (!exception)
+        exception = std::current_exception();
+    }
+  }
+
+
+  /// Rethrow the first exception, if any
+  void rethrow() {
+    if (exception)
+      std::rethrow_exception(exception);
+  }
+
+};
+
+}
+
+/// @} End the parallelism Doxygen group
+
+/*
+    # Some Emacs stuff:
+    ### Local Variables:
+    ### ispell-local-dictionary: "american"
+    ### eval: (flyspell-prog-mode)
+    ### End:
+*/
+
+#endif // TRISYCL_SYCL_PARALLELISM_DETAIL_FIRST_EXCEPTION_HPP
@@ -0,0 +1,230 @@
+#ifndef TRISYCL_SYCL_PARALLELISM_DETAIL_ITERATION_POLICY_HPP
+#define TRISYCL_SYCL_PARALLELISM_DETAIL_ITERATION_POLICY_HPP
+
+/** \file
+
+    The order in which the work-items of a parallel_for on a range<>
+    are iterated by the host threads
+
+    This file is distributed under the University of Illinois Open Source
+    License. See LICENSE.TXT for details.
+*/
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "triSYCL/id.hpp"
+#include "triSYCL/item.hpp"
+#include "triSYCL/range.hpp"
+
+/** \addtogroup parallelism
+    @{
+*/
+
+namespace trisycl::detail {
+
+/** How the iteration space of a parallel_for on a range<> is walked
+
+    With a tiled order, the iteration space is cut in tiles which are
+    each executed entirely by one thread, so that the neighbouring
+    work-items of a 2D or 3D stencil or transposition processed by a
+    thread share the same cache lines. The tiles are distributed in
+    row-major order, or in Morton (Z) order to keep also the
+    consecutive tiles of a thread close in every dimension.
+
+    The TBB engine also takes from it the way to split the iteration
+    space in tasks.
+*/
+struct iteration_policy {
+
+  enum class order {
+    /// Plain row-major order, the last dimension varying the fastest
+    row_major,
+    /// Row-major order of the tiles
+    tiled,
+    /// Morton order of the tiles
+    morton
+  };
+
+  order traversal = order::row_major;
+
+  /// The tile size in each dimension, only used by the tiled orders
+  std::array<std::size_t, 3> tile { 1, 1, 1 };
+
+  /// How the TBB engine splits the iteration space between its threads
+  enum class partitioner_kind {
+    /// Split adaptively according to the work stealing
+    automatic,
+    /// Split evenly once in as many chunks as threads
+    static_split,
+    /// Replay the split and thread placement of the previous launch of
+    /// the same kernel
+    affinity
+  };
+
+  partitioner_kind partitioner = partitioner_kind::automatic;
+
+  /** The minimum number of work-items executed by a TBB task, to
+      amortize the task overhead on cheap kernels */
+  std::size_t grain = 1;
+
+};
+
+
+/** Compute the id<> of a linear index in a range<> iterated in
+    row-major order, with the last dimension varying the fastest as
+    with parallel_for_iterate
+*/
+template <int Dimensions>
+id<Dimensions> row_major_id(std::size_t linear, const range<Dimensions> &r) {
+  id<Dimensions> index;
+  for (int d = Dimensions - 1; d >= 0; --d) {
+    index[d] = linear % r[d];
+    linear /= r[d];
+  }
+  return index;
+}
+
+
+/** Move an id<> to the next point of a range<> iterated in row-major
+    order, like an odometer, to avoid any division in the inner loop
+*/
+template <int Dimensions>
+void row_major_next(id<Dimensions> &index, const range<Dimensions> &r) {
+  for (int d = Dimensions - 1; d > 0; --d) {
+    if (++index[d] != r[d])
+      return;
+    index[d] = 0;
+  }
+  ++index[0];
+}
+
+
+/** Compute the Morton code of a tile by interleaving the bits of its
+    coordinates, the last dimension providing the lowest bit
+*/
+template <int Dimensions>
+std::uint64_t morton_code(const id<Dimensions> &tile) {
+  std::uint64_t code = 0;
+  for (int bit = 0; bit*Dimensions < 64; ++bit)
+    for (int d = 0; d < Dimensions && bit*Dimensions + d < 64; ++d)
+      code |= std::uint64_t((tile[Dimensions - 1 - d] >> bit) & 1)
+        << (bit*Dimensions + d);
+  return code;
+}
+
+
+/** The tiles of a range<> in the order they are to be distributed on
+    the threads according to an iteration policy
+*/
+template <int Dimensions>
+class tile_schedule {
+
+  /// The whole iteration space
+  range<Dimensions> r;
+
+  /// The size of a full tile
+  range<Dimensions> tile;
+
+  /// The number of tiles in each dimension, the last ones being partial
+  range<Dimensions> grid;
+
+  /** The row-major linear index of the tiles in Morton order, or empty
+      when the tiles are in row-major order */
+  std::vector<std::size_t> order;
+
+public:
+
+  tile_schedule(const range<Dimensions> &r, const iteration_policy &p)
+    : r { r }, tile { r }, grid { r } {
+    for (int d = 0; d < Dimensions; ++d) {
+      tile[d] = std::max<std::size_t>(1, std::min(p.tile[d], r[d]));
+      grid[d] = (r[d] + tile[d] - 1)/tile[d];
+    }
+    if (p.traversal == iteration_policy::order::morton && grid.size() > 1) {
+      std::vector<std::pair<std::uint64_t, std::size_t>> codes;
+      codes.reserve(grid.size());
+      auto t = row_major_id(0, grid);
+      for (std::size_t i = 0; i != grid.size(); ++i) {
+        codes.emplace_back(morton_code(t), i);
+        row_major_next(t, grid);
+      }
+      std::sort(codes.begin(), codes.end());
+      order.reserve(codes.size());
+      for (auto &c : codes)
+        order.push_back(c.second);
+    }
+  }
+
+
+  /// The number of tiles
+  std::size_t size() const {
+    return r.size() == 0 ? 0 : grid.size();
+  }
+
+
+  /// The number of work-items of a full tile
+  std::size_t tile_size() const {
+    return tile.size();
+  }
+
+
+  /// Get the coordinates in the tile grid of the t-th tile to execute
+  id<Dimensions> tile_id(std::size_t t) const {
+    return row_major_id(order.empty() ? t : order[t], grid);
+  }
+
+
+  /** Call f on all the points of the t-th tile in row-major order
+
+      The innermost dimension is a plain loop inside the tile.
+  */
+  template <typename F>
+  void for_each_point(std::size_t t, F &&f) const {
+    id<Dimensions> first = tile_id(t)*id<Dimensions>(tile);
+    range<Dimensions> extent = tile;
+    for (int d = 0; d < Dimensions; ++d)
+      extent[d] = std::min(tile[d], r[d] - first[d]);
+    const std::size_t inner = extent[Dimensions - 1];
+    const std::size_t rows = extent.size()/inner;
+    for (std::size_t row = 0; row != rows; ++row) {
+      id<Dimensions> index = first + row_major_id(row*inner, extent);
+      for (std::size_t i = 0; i != inner; ++i) {
+        f(index);
+        ++index[Dimensions - 1];
+      }
+    }
+  }
+
+};
+
+
+/// Call a range<> kernel with an id<> or with an item<> as it expects
+template <int Dimensions, typename ParallelForFunctor>
+void call_range_kernel(ParallelForFunctor &f,
+                       const range<Dimensions> &r,
+                       const id<Dimensions> &index) {
+  if constexpr (std::is_invocable_v<ParallelForFunctor &, id<Dimensions>>)
+    f(index);
+  else
+    f(item<Dimensions> { r, index });
+}
+
+/// @} End the parallelism Doxygen group
+
+}
+
+/*
+    # Some Emacs stuff:
+    ### Local Variables:
+    ### ispell-local-dictionary: "american"
+    ### eval: (flyspell-prog-mode)
+    ### End:
+*/
+
+#endif // TRISYCL_SYCL_PARALLELISM_DETAIL_ITERATION_POLICY_HPP
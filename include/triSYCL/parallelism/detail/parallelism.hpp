@@ -13,16 +13,27 @@
     License. See LICENSE.TXT for details.
 */
 
+#include <algorithm>
+#include <atomic>
 #include <cstddef>
+#include <limits>
+#include <thread>
 #include <boost/multi_array.hpp>
 
+#include "triSYCL/detail/local_memory_slot.hpp"
+#include "triSYCL/detail/numa.hpp"
 #include "triSYCL/group.hpp"
 #include "triSYCL/h_item.hpp"
 #include "triSYCL/id.hpp"
 #include "triSYCL/item.hpp"
 #include "triSYCL/nd_item.hpp"
 #include "triSYCL/nd_range.hpp"
+#include "triSYCL/parallelism/detail/first_exception.hpp"
+#include "triSYCL/parallelism/detail/iteration_policy.hpp"
+#include "triSYCL/parallelism/detail/thread_budget.hpp"
+#include "triSYCL/parallelism/detail/work_group_collective.hpp"
 #include "triSYCL/range.hpp"
+#include "triSYCL/reduction.hpp"
 
 #if defined(TRISYCL_USE_OPENCL_ND_RANGE)
 #include "triSYCL/detail/SPIR/opencl_spir_helpers.hpp"
@@ -32,6 +43,10 @@
 #include <omp.h>
 #endif
 
+#ifdef TRISYCL_FIBER_BARRIER
+#include "triSYCL/parallelism/detail/fiber.hpp"
+#endif
+
 
 /** \addtogroup parallelism
     @{
@@ -70,45 +85,58 @@ struct parallel_for_iterate {
 };
 
 #ifdef _OPENMP
-/** A top-level recursive multi-dimensional iterator variant using OpenMP
+/** Iterate on the chunk of a collapsed multi-dimensional iteration
+    space owned by the current thread of an OpenMP parallel region
+
+    The whole iteration space is linearized and split in contiguous
+    chunks of the same size, one per OpenMP thread, so the load balance
+    does not depend on the size of the outermost dimension, such as
+    with a range<2> { 4, 1000000 }.
 
-    Only the top-level loop uses OpenMP and goes on with the normal
-    recursive multi-dimensional.
+    Each chunk is delinearized only once into an id<> and then walked
+    in row-major order, so the consecutive work-items of a thread are
+    contiguous in the innermost dimension.
 */
-template <std::size_t level,
-          typename Range,
-          typename ParallelForFunctor,
-          typename Id>
-struct parallel_OpenMP_for_iterate {
-  parallel_OpenMP_for_iterate(Range r, ParallelForFunctor &f) {
-    // Create the OpenMP threads before the for-loop to avoid creating an
-    // index in each iteration
-#pragma omp parallel
-    {
-      // Allocate an OpenMP thread-local index
-      Id index;
-      // Make a simple loop end condition for OpenMP
-      boost::multi_array_types::index _sycl_end =
-        r[Range::dimensionality - level];
-      /* Distribute the iterations on the OpenMP threads. Some OpenMP
-         "collapse" could be useful for small iteration space, but it
-         would need some template specialization to have real contiguous
-         loop nests */
-#pragma omp for
-      for (boost::multi_array_types::index _sycl_index = 0;
-           _sycl_index < _sycl_end;
-           _sycl_index++) {
-        // Set the current value of the index for this dimension
-        index[Range::dimensionality - level] = _sycl_index;
-        // Iterate further on lower dimensions
-        parallel_for_iterate<level - 1,
-                             Range,
-                             ParallelForFunctor,
-                             Id> { r, f, index };
-      }
+template <int Dimensions, typename ParallelForFunctor>
+void OpenMP_for_collapsed_chunk(const range<Dimensions> &r,
+                                ParallelForFunctor &f) {
+  const auto [begin, end] =
+    thread_budget::static_chunk(r.size(), omp_get_num_threads(),
+                                omp_get_thread_num());
+  if (begin < end) {
+    // Allocate an OpenMP thread-local index
+    auto index = row_major_id(begin, r);
+    for (std::size_t i = begin; i != end; ++i) {
+      f(index);
+      row_major_next(index, r);
     }
   }
-};
+}
+
+
+/** A collapsed multi-dimensional iterator variant using OpenMP
+
+    The thread team is sized by the share of the thread budget of the
+    running kernel, up to \param max_threads, and its threads are
+    pinned if requested.
+
+    The first exception thrown by the kernel is rethrown once the
+    region has ended, since it cannot escape it.
+*/
+template <int Dimensions, typename ParallelForFunctor>
+void parallel_OpenMP_for_collapsed(const range<Dimensions> &r,
+                                   ParallelForFunctor &f,
+                                   std::size_t max_threads =
+                                   std::numeric_limits<std::size_t>::max()) {
+  first_exception e;
+#pragma omp parallel num_threads(std::min(thread_budget::team_size(), \
+                                          max_threads))
+  {
+    numa::pin_team_thread(omp_get_thread_num());
+    e.run([&] { OpenMP_for_collapsed_chunk(r, f); });
+  }
+  e.rethrow();
+}
 #endif
 
 
@@ -132,11 +160,8 @@ void parallel_for(range<Dimensions> r,
                   ParallelForFunctor f,
                   Id) {
 #ifdef _OPENMP
-  // Use OpenMP for the top loop level
-  parallel_OpenMP_for_iterate<Dimensions,
-                              range<Dimensions>,
-                              ParallelForFunctor,
-                              id<Dimensions>> { r, f };
+  // Use OpenMP on the whole collapsed iteration space
+  parallel_OpenMP_for_collapsed(r, f);
 #else
   // In a sequential execution there is only one index processed at a time
   id<Dimensions> index;
@@ -164,11 +189,8 @@ void parallel_for(range<Dimensions> r,
     f(index);
   };
 #ifdef _OPENMP
-  // Use OpenMP for the top loop level
-  parallel_OpenMP_for_iterate<Dimensions,
-                              range<Dimensions>,
-                              decltype(reconstruct_item),
-                              id<Dimensions>> { r, reconstruct_item };
+  // Use OpenMP on the whole collapsed iteration space
+  parallel_OpenMP_for_collapsed(r, reconstruct_item);
 #else
   // In a sequential execution there is only one index processed at a time
   id<Dimensions> index;
@@ -247,24 +269,114 @@ void parallel_for_global_offset(range<Dimensions> global_size,
 }
 
 
-/// Implement the loop on the work-groups
+/** Implementation of parallel_for with a range<> iterated according
+    to an iteration policy
+
+    With a tiled policy, the ordered tiles are split in contiguous
+    chunks, one per OpenMP thread, and each tile is executed entirely
+    by its thread.
+*/
 template <int Dimensions = 1, typename ParallelForFunctor>
-void parallel_for_workgroup(nd_range<Dimensions> r,
-                            ParallelForFunctor f) {
-  // In a sequential execution there is only one index processed at a time
-  group<Dimensions> g { r };
+void parallel_for_policy(range<Dimensions> r,
+                         const iteration_policy &policy,
+                         ParallelForFunctor f) {
+  if (policy.traversal == iteration_policy::order::row_major) {
+    parallel_for(r, f);
+    return;
+  }
+  const tile_schedule<Dimensions> schedule { r, policy };
+  auto tile = [&] (id<1> t) {
+    schedule.for_each_point(t[0], [&] (const id<Dimensions> &index) {
+        call_range_kernel(f, r, index);
+      });
+  };
+#ifdef _OPENMP
+  parallel_OpenMP_for_collapsed(range<1> { schedule.size() }, tile);
+#else
+  for (std::size_t t = 0; t != schedule.size(); ++t)
+    tile(t);
+#endif
+}
 
-  // First iterate on all the work-groups
-  parallel_for_iterate<Dimensions,
-                       range<Dimensions>,
-                       ParallelForFunctor,
-                       group<Dimensions>> {
-    r.get_group_range(),
-    f,
-    g };
+
+/** Implement the loop on the work-items inside a work-group in the
+    current thread, without any support for barriers
+
+    The work-items are iterated in row-major order and the innermost
+    dimension is a plain loop that the compiler is allowed to
+    vectorize, since the work-items are independent when there is no
+    barrier.
+
+    \param Vectorize has to be false when the work-items update a
+    shared state, such as the reducer of a reduction, since this would
+    be a dependence between the iterations of the vectorized loop
+*/
+template <int Dimensions, typename T_Item, typename ParallelForFunctor,
+          bool Vectorize = true>
+void parallel_for_workitem_serial(const group<Dimensions> &g,
+                                  ParallelForFunctor &f) {
+  const range<Dimensions> l_r = g.get_local_range();
+  const id<Dimensions> offset = id<Dimensions>(l_r)*g.get_id();
+  const std::size_t inner = l_r[Dimensions - 1];
+  const std::size_t rows = inner == 0 ? 0 : l_r.size()/inner;
+
+  for (std::size_t row = 0; row < rows; ++row) {
+    const id<Dimensions> first = row_major_id(row*inner, l_r);
+    auto work_item = [&] (std::size_t i) {
+      T_Item index { g.get_nd_range() };
+      id<Dimensions> local = first;
+      local[Dimensions - 1] = i;
+      index.set_local(local);
+      index.set_global(local + offset);
+      f(index);
+    };
+    if constexpr (Vectorize) {
+      /* An exception cannot escape an OpenMP simd loop, so the first
+         one is rethrown after it. The handler is optimized away for a
+         kernel which cannot throw, keeping the loop vectorizable */
+      first_exception e;
+#ifdef _OPENMP
+#pragma omp simd
+#endif
+      for (std::size_t i = 0; i < inner; ++i)
+        e.run([&] { work_item(i); });
+      e.rethrow();
+    }
+    else
+      for (std::size_t i = 0; i < inner; ++i)
+        work_item(i);
+  }
 }
 
 
+#ifdef TRISYCL_FIBER_BARRIER
+/** Implement the work-items of a work-group as fibers in the current
+    thread, so that the barriers work without a thread per work-item
+*/
+template <int Dimensions, typename T_Item, typename ParallelForFunctor>
+void parallel_for_workitem_fiber(const group<Dimensions> &g,
+                                 ParallelForFunctor &f) {
+  const range<Dimensions> l_r = g.get_local_range();
+  const id<Dimensions> offset = id<Dimensions>(l_r)*g.get_id();
+
+  auto work_item = [&] (std::size_t linear) {
+    T_Item index { g.get_nd_range() };
+    const id<Dimensions> local = row_major_id(linear, l_r);
+    index.set_local(local);
+    index.set_global(local + offset);
+    f(index);
+  };
+  // The group collectives synchronize with the fiber switches
+  work_group_collective collective { l_r.size(),
+                                     work_group_fibers::barrier,
+                                     work_group_fibers::current_work_item,
+                                     work_group_fibers::wait_while_equal };
+  work_group_collective::scope scope { collective };
+  work_group_fibers::run(l_r.size(), work_item);
+}
+#endif
+
+
 /** Implement the loop on the work-items inside a work-group
 
     \todo Better type the functor
@@ -285,13 +397,36 @@ void parallel_for_workitem(const group<Dimensions> &g,
 
   auto tot = l_r.size();
 
+  /* The group collectives synchronize with OpenMP barriers, the rank
+     of a work-item being the one of the thread executing it, and the
+     sub-groups spin on their counter */
+  work_group_collective collective {
+    tot,
+    [] {
+#pragma omp barrier
+    },
+    [] { return std::size_t(omp_get_thread_num()); },
+    [] (const std::atomic<std::size_t> &value, std::size_t old) {
+      while (value.load(std::memory_order_acquire) == old)
+        std::this_thread::yield();
+    }
+  };
+  /* An exception cannot escape the OpenMP loop, so the first one is
+     rethrown after it. A work-item throwing before a barrier still
+     leaves the other work-items of the group waiting for it */
+  first_exception e;
+  auto work_item = [&] (T_Item &index) {
+    work_group_collective::scope scope { collective };
+    e.run([&] { f(index); });
+  };
+
   if constexpr (Dimensions == 1) {
   #pragma omp parallel for collapse(1) schedule(static) num_threads(tot)
     for (size_t i = 0; i < l_r.get(0); ++i) {
       T_Item index{g.get_nd_range()};
       index.set_local(i);
       index.set_global(index.get_local_id() + id_l_r * g.get_id());
-      f(index);
+      work_item(index);
     }
   } else if constexpr (Dimensions == 2) {
   #pragma omp parallel for collapse(2) schedule(static) num_threads(tot)
@@ -300,7 +435,7 @@ void parallel_for_workitem(const group<Dimensions> &g,
         T_Item index{g.get_nd_range()};
         index.set_local({i,j});
         index.set_global(index.get_local_id() + id_l_r * g.get_id());
-        f(index);
+        work_item(index);
       }
     }
   } else if constexpr (Dimensions == 3) {
@@ -311,154 +446,224 @@ void parallel_for_workitem(const group<Dimensions> &g,
           T_Item index{g.get_nd_range()};
           index.set_local({i,j,k});
           index.set_global(index.get_local_id() + id_l_r * g.get_id());
-          f(index);
-        }
-  }
-#elif defined(_OPENMP) && (defined(TRISYCL_NO_BARRIER) && !defined(_MSC_VER))
-  range<Dimensions> l_r = g.get_nd_range().get_local_range();
-  id<Dimensions> id_l_r { l_r };
-
-  if constexpr (Dimensions == 1) {
-  #pragma omp parallel for simd collapse(1)
-    for (size_t i = 0; i < l_r.get(0); ++i) {
-      T_Item index{g.get_nd_range()};
-      index.set_local(i);
-      index.set_global(index.get_local_id() + id_l_r * g.get_id());
-      f(index);
-    }
-  } else if constexpr (Dimensions == 2) {
-  #pragma omp parallel for simd collapse(2)
-    for (size_t i = 0; i < l_r.get(0); ++i) {
-      for (size_t j = 0; j < l_r.get(1); ++j) {
-        T_Item index{g.get_nd_range()};
-        index.set_local({i,j});
-        index.set_global(index.get_local_id() + id_l_r * g.get_id());
-        f(index);
-      }
-    }
-  } else if constexpr (Dimensions == 3) {
-    #pragma omp parallel for simd collapse(3)
-    for (size_t i = 0; i < l_r.get(0); ++i)
-      for (size_t j = 0; j < l_r.get(1); ++j)
-        for (size_t k = 0; k < l_r.get(2); ++k) {
-          T_Item index{g.get_nd_range()};
-          index.set_local({i,j,k});
-          index.set_global(index.get_local_id() + id_l_r * g.get_id());
-          f(index);
+          work_item(index);
         }
   }
+  e.rethrow();
 #else
-  // In a sequential execution there is only one index processed at a time
-  T_Item index { g.get_nd_range() };
-  // To iterate on the local work-item
-  id<Dimensions> local;
+  // In a sequential execution the work-items are just a loop
+  parallel_for_workitem_serial<Dimensions, T_Item>(g, f);
+#endif
+}
 
-  // Reconstruct the item from its group and local id
-  auto reconstruct_item = [&] (id<Dimensions> l) {
-    //local.display();
-    //l.display();
-    // Reconstruct the global item
-    index.set_local(local);
-    // \todo Some strength reduction here
-    index.set_global(local + id<Dimensions>(g.get_local_range())*g.get_id());
-    // Call the user kernel at last
-    f(index);
+
+/** Distribute the work-groups of a nd_range<> on the threads, each
+    work-group being executed by a single thread
+*/
+template <int Dimensions, typename WorkGroupFunctor>
+void parallel_for_each_group(const nd_range<Dimensions> &r,
+                             WorkGroupFunctor work_group) {
+  auto iterate_in_work_group = [&] (id<Dimensions> g) {
+#ifdef _OPENMP
+    // The concurrent work-groups need their own local memory
+    local_memory_slot_scope slot { std::size_t(omp_get_thread_num()) };
+#endif
+    work_group(trisycl::group<Dimensions> { g, r });
   };
 
-  // Then iterate on all the work-items of the work-group
+#ifdef _OPENMP
+  // Each thread needs its own local memory slot
+  parallel_OpenMP_for_collapsed(r.get_group_range(), iterate_in_work_group,
+                                max_local_memory_slots);
+#else
+  // In a sequential execution there is only one group processed at a time
+  id<Dimensions> group;
   parallel_for_iterate<Dimensions,
                        range<Dimensions>,
-                       decltype(reconstruct_item),
-                       id<Dimensions>> {
-    g.get_local_range(),
-    reconstruct_item,
-    local };
+                       decltype(iterate_in_work_group),
+                       id<Dimensions>> { r.get_group_range(),
+                                         iterate_in_work_group,
+                                         group };
 #endif
 }
 
 
+/** Implement the loop on the work-groups of a hierarchical kernel
+
+    The work-groups are distributed on the threads and each
+    parallel_for_work_item inside is then a plain loop executed by the
+    thread running the work-group, so there is no thread team to
+    create per work-group.
+*/
+template <int Dimensions = 1, typename ParallelForFunctor>
+void parallel_for_workgroup(nd_range<Dimensions> r,
+                            ParallelForFunctor f) {
+  parallel_for_each_group(r, f);
+}
+
+
 /** Implement a variation of parallel_for to take into account a
-    nd_range<>
+    nd_range<> for kernels not using any barrier
 
-    \todo Add an OpenMP implementation
+    Since the work-items of a work-group do not have to wait for each
+    other, the work-groups are distributed on the threads and each
+    work-group is executed as a plain loop by a single thread, without
+    creating any thread team.
+
+    It is invalid to call nd_item::barrier() from such a kernel.
+*/
+template <int Dimensions = 1, typename ParallelForFunctor>
+void parallel_for_no_barrier(nd_range<Dimensions> r,
+                             ParallelForFunctor f) {
+  parallel_for_each_group(r, [&] (const group<Dimensions> &g) {
+      parallel_for_workitem_serial<Dimensions, nd_item<Dimensions>>(g, f);
+    });
+}
 
-    \todo Deal with incomplete work-groups
 
-    \todo Implement with parallel_for_workgroup()/parallel_for_workitem()
+/** Implement a variation of parallel_for to take into account a
+    nd_range<>
+
+    \todo Deal with incomplete work-groups
 */
 template <int Dimensions = 1, typename ParallelForFunctor>
 void parallel_for(nd_range<Dimensions> r,
                   ParallelForFunctor f) {
-  // To iterate on the work-group
-  id<Dimensions> group;
-  range<Dimensions> group_range = r.get_group_range();
-
-#ifdef _OPENMP
-
+#if defined(TRISYCL_FIBER_BARRIER) && !defined(TRISYCL_NO_BARRIER)
+  /* Distribute the work-groups on the threads, each thread running
+     the work-items of a work-group as fibers */
+  parallel_for_each_group(r, [&] (const group<Dimensions> &g) {
+      parallel_for_workitem_fiber<Dimensions, nd_item<Dimensions>>(g, f);
+    });
+#elif defined(_OPENMP) && (!defined(TRISYCL_NO_BARRIER) && !defined(_MSC_VER))
+  /* Execute the work-groups one after the other, each one with a team
+     of threads to support nd_item::barrier() */
   auto iterate_in_work_group = [&] (id<Dimensions> g) {
-    //group.display();
-
-    // Then iterate on the local work-groups
-    trisycl::group<Dimensions> wg {g, r};
+    trisycl::group<Dimensions> wg { g, r };
     parallel_for_workitem<Dimensions,
                           nd_item<Dimensions>,
                           decltype(f)>(wg, f);
   };
 
-#else
-
-  // In a sequential execution there is only one index processed at a time
-  nd_item<Dimensions> index { r };
-
-  // To iterate on the local work-item
-  id<Dimensions> local;
-  range<Dimensions> local_range = r.get_local_range();
-
-  // Reconstruct the item from its group and local id
-  auto reconstruct_item = [&] (id<Dimensions> l) {
-    //local.display();
-    // Reconstruct the global item
-    index.set_local(local);
-    // Upgrade local_range to an id<> so that we can * with the group (an id<>)
-    index.set_global(local + id<Dimensions>(local_range)*group);
-    // Call the user kernel at last
-    f(index);
-  };
-
-  /* To recycle the parallel_for on range<>, wrap the ParallelForFunctor f
-     into another functor that iterates inside the work-group and then
-     calls f */
-  auto iterate_in_work_group = [&] (id<Dimensions> g) {
-    //group.display();
-    // Then iterate on the local work-groups
-    parallel_for_iterate<Dimensions,
-                         range<Dimensions>,
-                         decltype(reconstruct_item),
-                         id<Dimensions>> { local_range,
-                                           reconstruct_item,
-                                           local };
-  };
-
-#endif
-
-  // First iterate on all the work-groups
+  id<Dimensions> group;
   parallel_for_iterate<Dimensions,
                        range<Dimensions>,
                        decltype(iterate_in_work_group),
-                       id<Dimensions>> { group_range,
+                       id<Dimensions>> { r.get_group_range(),
                                          iterate_in_work_group,
                                          group };
+#else
+  // Without barrier support, there is nothing to synchronize inside groups
+  parallel_for_no_barrier(r, f);
+#endif
 }
 
 
 /** Implement the loop on the work-items inside a work-group
+
+    The thread executing the work-group runs the work-items one after
+    the other, the end of the loop being the implicit barrier of
+    parallel_for_work_item.
 */
 template <int Dimensions, typename ParallelForFunctor>
 void parallel_for_workitem_in_group(const group<Dimensions> &g,
                                     ParallelForFunctor f) {
-  parallel_for_workitem<Dimensions,
-                        h_item<Dimensions>,
-                        ParallelForFunctor>(g, f);
+  parallel_for_workitem_serial<Dimensions, h_item<Dimensions>>(g, f);
+}
+
+
+/** Implement a parallel_for on a range<> with a reduction
+
+    Each thread accumulates the work-items it executes into a private
+    reducer and the partial results of the threads are then combined
+    with a tree.
+*/
+template <int Dimensions, typename Reduction, typename ParallelForFunctor>
+void parallel_for_reduce(range<Dimensions> r,
+                         Reduction red,
+                         ParallelForFunctor f) {
+#ifdef _OPENMP
+  const std::size_t threads = thread_budget::team_size();
+  reduction_partials partials { threads,
+                                Reduction::partial(red.make_reducer()),
+                                red.get_combiner() };
+  first_exception e;
+#pragma omp parallel num_threads(threads)
+  {
+    auto reducer = red.make_reducer();
+    auto kernel = [&] (const id<Dimensions> &index) {
+      call_reduction_kernel(f, r, index, reducer);
+    };
+    e.run([&] { OpenMP_for_collapsed_chunk(r, kernel); });
+    partials.combine(omp_get_thread_num(), Reduction::partial(reducer));
+  }
+  // Do not commit the partial result of a failed kernel
+  e.rethrow();
+  red.commit(partials.tree_combine());
+#else
+  auto reducer = red.make_reducer();
+  auto kernel = [&] (const id<Dimensions> &index) {
+    call_reduction_kernel(f, r, index, reducer);
+  };
+  id<Dimensions> index;
+  parallel_for_iterate<Dimensions,
+                       range<Dimensions>,
+                       decltype(kernel),
+                       id<Dimensions>> { r, kernel, index };
+  red.commit(Reduction::partial(reducer));
+#endif
+}
+
+
+/** Implement a parallel_for on a nd_range<> with a reduction
+
+    The work-items of a work-group executed by a thread share a
+    reducer, which is combined at the end of the work-group into the
+    partial result of the thread. The partial results of the threads
+    are then combined with a tree.
+*/
+template <int Dimensions, typename Reduction, typename ParallelForFunctor>
+void parallel_for_reduce(nd_range<Dimensions> r,
+                         Reduction red,
+                         ParallelForFunctor f) {
+#if defined(_OPENMP) && !defined(TRISYCL_FIBER_BARRIER) \
+  && (!defined(TRISYCL_NO_BARRIER) && !defined(_MSC_VER))
+  /* The work-groups are executed one after the other by a team with a
+     thread per work-item, so accumulate per team thread */
+  reduction_partials partials { r.get_local_range().size(),
+                                Reduction::partial(red.make_reducer()),
+                                red.get_combiner() };
+  parallel_for(r, [&] (nd_item<Dimensions> index) {
+      auto reducer = red.make_reducer();
+      f(index, reducer);
+      partials.combine(omp_get_thread_num(), Reduction::partial(reducer));
+    });
+#else
+#ifdef _OPENMP
+  // The work-groups are distributed on a team of this size
+  const std::size_t threads = std::min(thread_budget::team_size(),
+                                       max_local_memory_slots);
+#else
+  const std::size_t threads = 1;
+#endif
+  reduction_partials partials { threads,
+                                Reduction::partial(red.make_reducer()),
+                                red.get_combiner() };
+  parallel_for_each_group(r, [&] (const group<Dimensions> &g) {
+      auto reducer = red.make_reducer();
+      auto kernel = [&] (nd_item<Dimensions> index) { f(index, reducer); };
+#if defined(TRISYCL_FIBER_BARRIER) && !defined(TRISYCL_NO_BARRIER)
+      parallel_for_workitem_fiber<Dimensions, nd_item<Dimensions>>(g, kernel);
+#else
+      // The shared reducer prevents the vectorization of the work-items
+      parallel_for_workitem_serial<Dimensions, nd_item<Dimensions>,
+                                   decltype(kernel), false>(g, kernel);
+#endif
+      // The thread running the work-group is identified by its slot
+      partials.combine(local_memory_slot, Reduction::partial(reducer));
+    });
+#endif
+  red.commit(partials.tree_combine());
 }
 
 
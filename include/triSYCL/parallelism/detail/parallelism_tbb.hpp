@@ -13,17 +13,32 @@
     License. See LICENSE.TXT for details.
 */
 
+#include <algorithm>
+#include <cstddef>
+#include <mutex>
+
+#include "triSYCL/detail/local_memory_slot.hpp"
 #include "triSYCL/group.hpp"
 #include "triSYCL/h_item.hpp"
 #include "triSYCL/id.hpp"
 #include "triSYCL/item.hpp"
 #include "triSYCL/nd_item.hpp"
 #include "triSYCL/nd_range.hpp"
+#include "triSYCL/parallelism/detail/iteration_policy.hpp"
+#include "triSYCL/parallelism/detail/work_group_collective.hpp"
 #include "triSYCL/range.hpp"
+#include "triSYCL/reduction.hpp"
 
 #include <tbb/blocked_range2d.h>
 #include <tbb/blocked_range3d.h>
 #include <tbb/parallel_for.h>
+#include <tbb/partitioner.h>
+#include <tbb/parallel_reduce.h>
+#include <tbb/task_arena.h>
+
+#ifdef TRISYCL_FIBER_BARRIER
+#include "triSYCL/parallelism/detail/fiber.hpp"
+#endif
 
 /** \addtogroup parallelism
     @{
@@ -31,47 +46,149 @@
 
 namespace trisycl::detail {
 
-static inline auto to_tbb_range(const range<1> &r)
+/** Compute the TBB grain size of each dimension of a range<>
+
+    The innermost dimension gets as much of the grain as possible, so
+    that a TBB task iterates at least grain work-items and keeps a
+    long contiguous inner loop.
+*/
+template <int Dimensions>
+range<Dimensions> tbb_grains(const range<Dimensions> &r, std::size_t grain)
+{
+  range<Dimensions> grains = r;
+  std::size_t remaining = std::max<std::size_t>(1, grain);
+  for (int d = Dimensions - 1; d >= 0; --d) {
+    grains[d] = std::max<std::size_t>(1, std::min(remaining, r[d]));
+    remaining = (remaining + grains[d] - 1) / grains[d];
+  }
+  return grains;
+}
+
+static inline auto to_tbb_range(const range<1> &r, std::size_t grain = 1)
+{
+  const auto g = tbb_grains(r, grain);
+  return tbb::blocked_range<size_t>(0, r[0], g[0]);
+}
+
+static inline auto to_tbb_range(const range<2> &r, std::size_t grain = 1)
 {
-  return tbb::blocked_range<size_t>(0, r[0]);
+  const auto g = tbb_grains(r, grain);
+  return tbb::blocked_range2d<size_t>(0, r[0], g[0], 0, r[1], g[1]);
 }
 
-static inline auto to_tbb_range(const range<2> &r)
+static inline auto to_tbb_range(const range<3> &r, std::size_t grain = 1)
 {
-  return tbb::blocked_range2d<size_t>(0, r[0], 0, r[1]);
+  const auto g = tbb_grains(r, grain);
+  return tbb::blocked_range3d<size_t>(0, r[0], g[0],
+                                      0, r[1], g[1],
+                                      0, r[2], g[2]);
 }
 
-static inline auto to_tbb_range(const range<3> &r)
+/// Iterate on all the points of a TBB sub-range
+template <typename F>
+static inline void for_each_point(const tbb::blocked_range<size_t> &sub,
+                                  F &&f)
 {
-  return tbb::blocked_range3d<size_t>(0, r[0], 0, r[1], 0, r[2]);
+  for (auto i = sub.begin(); i != sub.end(); ++i)
+    f(make_id(i));
 }
 
-static inline auto to_sycl_id(const tbb::blocked_range<size_t> &in)
+template <typename F>
+static inline void for_each_point(const tbb::blocked_range2d<size_t> &sub,
+                                  F &&f)
 {
-  return make_id(in.begin());
+  for (auto i = sub.rows().begin(); i != sub.rows().end(); ++i)
+    for (auto j = sub.cols().begin(); j != sub.cols().end(); ++j)
+      f(make_id(i, j));
 }
 
-static inline auto to_sycl_id(const tbb::blocked_range2d<size_t> &in)
+template <typename F>
+static inline void for_each_point(const tbb::blocked_range3d<size_t> &sub,
+                                  F &&f)
 {
-  const auto cols = in.cols().begin();
-  const auto rows = in.rows().begin();
-  return make_id(rows, cols);
+  for (auto i = sub.pages().begin(); i != sub.pages().end(); ++i)
+    for (auto j = sub.rows().begin(); j != sub.rows().end(); ++j)
+      for (auto k = sub.cols().begin(); k != sub.cols().end(); ++k)
+        f(make_id(i, j, k));
 }
 
-static inline auto to_sycl_id(const tbb::blocked_range3d<size_t> &in)
+/** Run a TBB parallel_for with the partitioner of an iteration policy
+
+    There is an affinity_partitioner for each loop body type, that is
+    for each kernel, so that the repeated launches of a kernel replay
+    the thread placement of the previous one while the data are still
+    in the caches of the same threads. Since an affinity_partitioner
+    cannot be used by concurrent loops, a launch of the kernel
+    overlapping another one just uses an auto_partitioner.
+*/
+template <typename TBBRange, typename Body>
+void tbb_parallel_for(const TBBRange &r,
+                      const iteration_policy &policy,
+                      const Body &body)
 {
-  const auto pages = in.pages().begin();
-  const auto cols = in.cols().begin();
-  const auto rows = in.rows().begin();
-  return make_id(rows, cols, pages);
+  using partitioner_kind = iteration_policy::partitioner_kind;
+  switch (policy.partitioner) {
+  case partitioner_kind::static_split:
+    tbb::parallel_for(r, body, tbb::static_partitioner{});
+    return;
+
+  case partitioner_kind::affinity: {
+    static std::mutex in_use;
+    static tbb::affinity_partitioner affinity;
+    std::unique_lock<std::mutex> lock{in_use, std::try_to_lock};
+    if (lock.owns_lock()) {
+      tbb::parallel_for(r, body, affinity);
+      return;
+    }
+    break;
+  }
+
+  case partitioner_kind::automatic:
+    break;
+  }
+  tbb::parallel_for(r, body, tbb::auto_partitioner{});
 }
 
+/** A recursive multi-dimensional sequential iterator that ends up
+    calling f, to iterate inside a task
+*/
+template <std::size_t level,
+          typename Range,
+          typename ParallelForFunctor,
+          typename Id>
+struct sequential_for_iterate {
+  sequential_for_iterate(Range r, ParallelForFunctor &f, Id &index)
+  {
+    for (std::size_t i = 0, end = r[Range::dimensionality - level];
+         i < end;
+         ++i) {
+      index[Range::dimensionality - level] = i;
+      sequential_for_iterate<level - 1, Range, ParallelForFunctor, Id>{
+          r, f, index};
+    }
+  }
+};
+
+/// Stop the recursion by calling the kernel functor with the index
+template <typename Range, typename ParallelForFunctor, typename Id>
+struct sequential_for_iterate<0, Range, ParallelForFunctor, Id> {
+  sequential_for_iterate(Range r, ParallelForFunctor &f, Id &index)
+  {
+    f(index);
+  }
+};
+
+/** Distribute a range<> on the TBB threads, each task calling f on
+    all the points of its sub-range in a plain loop
+*/
 template <typename Range, typename ParallelForFunctor>
-void parallel_for_iterate(Range r, ParallelForFunctor &f)
+void parallel_for_iterate(Range r,
+                          ParallelForFunctor &f,
+                          const iteration_policy &policy = {})
 {
-  tbb::parallel_for(to_tbb_range(r),
-                    [&](auto idx) { f(to_sycl_id(idx)); },
-                    tbb::simple_partitioner{});
+  tbb_parallel_for(to_tbb_range(r, policy.grain),
+                   policy,
+                   [&](const auto &sub) { for_each_point(sub, f); });
 }
 
 /** Implementation of a data parallel computation with parallelism
@@ -124,45 +241,158 @@ void parallel_for_global_offset(range<Dimensions> global_size,
   parallel_for(global_size, reconstruct_item);
 }
 
+/** Implementation of parallel_for with a range<> iterated according
+    to an iteration policy
+
+    The TBB partitioner and grain size come from the policy. With a
+    tiled policy, TBB distributes ranges of ordered tiles and each tile
+    is executed entirely by one thread.
+*/
+template <int Dimensions = 1, typename ParallelForFunctor>
+void parallel_for_policy(range<Dimensions> r,
+                         const iteration_policy &policy,
+                         ParallelForFunctor f)
+{
+  auto kernel = [&](const id<Dimensions> &index) {
+    call_range_kernel(f, r, index);
+  };
+  if (policy.traversal == iteration_policy::order::row_major) {
+    parallel_for_iterate(r, kernel, policy);
+    return;
+  }
+  const tile_schedule<Dimensions> schedule{r, policy};
+  // The grain is expressed in work-items, so convert it in tiles
+  const std::size_t grain =
+      std::max<std::size_t>(1, policy.grain / schedule.tile_size());
+  tbb_parallel_for(tbb::blocked_range<std::size_t>(0, schedule.size(), grain),
+                   policy,
+                   [&](const tbb::blocked_range<std::size_t> &tiles) {
+    for (auto t = tiles.begin(); t != tiles.end(); ++t)
+      schedule.for_each_point(t, kernel);
+  });
+}
+
+/** Distribute the work-groups of a nd_range<> with TBB, each
+    work-group being executed by a single thread
+*/
+template <int Dimensions, typename WorkGroupFunctor>
+void parallel_for_each_group(const nd_range<Dimensions> &r,
+                             WorkGroupFunctor work_group)
+{
+  auto iterate_in_work_group = [&](id<Dimensions> g) {
+    // The concurrent work-groups need their own local memory
+    local_memory_slot_scope slot{
+        std::size_t(tbb::this_task_arena::current_thread_index())};
+    work_group(trisycl::group<Dimensions>{g, r});
+  };
+
+  auto iterate = [&] {
+    parallel_for_iterate(r.get_group_range(), iterate_in_work_group);
+  };
+  // Each thread needs its own local memory slot
+  if (std::size_t(tbb::this_task_arena::max_concurrency())
+      > max_local_memory_slots) {
+    tbb::task_arena arena{int(max_local_memory_slots)};
+    arena.execute(iterate);
+  } else
+    iterate();
+}
+
 /// Implement the loop on the work-groups
 template <int Dimensions = 1, typename ParallelForFunctor>
 void parallel_for_workgroup(nd_range<Dimensions> r, ParallelForFunctor f)
 {
-  auto reconstruct_group = [&](id<Dimensions> l) {
-    group<Dimensions> group{l, r};
-    f(group);
-  };
+  parallel_for_each_group(r, f);
+}
 
-  parallel_for_iterate(r.get_group_range(), reconstruct_group);
+#ifdef TRISYCL_FIBER_BARRIER
+/** Implement the work-items of a work-group as fibers in the current
+    thread, so that the barriers work without a thread per work-item
+*/
+template <int Dimensions, typename T_Item, typename ParallelForFunctor>
+void parallel_for_workitem_fiber(const group<Dimensions> &g,
+                                 ParallelForFunctor &f)
+{
+  const range<Dimensions> l_r = g.get_local_range();
+  const id<Dimensions> offset = id<Dimensions>(l_r) * g.get_id();
+
+  auto work_item = [&](std::size_t linear) {
+    // Delinearize in row-major order, the last dimension varying fastest
+    id<Dimensions> local;
+    for (int d = Dimensions - 1; d >= 0; --d) {
+      local[d] = linear % l_r[d];
+      linear /= l_r[d];
+    }
+    T_Item index{g.get_nd_range()};
+    index.set_local(local);
+    index.set_global(local + offset);
+    f(index);
+  };
+  // The group collectives synchronize with the fiber switches
+  work_group_collective collective{l_r.size(),
+                                   work_group_fibers::barrier,
+                                   work_group_fibers::current_work_item,
+                                   work_group_fibers::wait_while_equal};
+  work_group_collective::scope scope{collective};
+  work_group_fibers::run(l_r.size(), work_item);
 }
+#endif
 
-/// Implement the loop on the work-items inside a work-group
+/** Implement the loop on the work-items inside a work-group
+
+    The work-items are executed as a plain loop by the thread running
+    the work-group.
+*/
 template <int Dimensions, typename T_Item, typename ParallelForFunctor>
 void parallel_for_workitem(const group<Dimensions> &g,
-                           ParallelForFunctor f)
+                           ParallelForFunctor &f)
 {
+  const id<Dimensions> offset =
+      id<Dimensions>(g.get_local_range()) * g.get_id();
+  T_Item index{g.get_nd_range()};
   auto reconstruct_item = [&](id<Dimensions> local) {
-    T_Item index{g.get_nd_range()};
     index.set_local(local);
-    index.set_global(local +
-                     id<Dimensions>(g.get_local_range()) * g.get_id());
+    index.set_global(local + offset);
     f(index);
   };
+  id<Dimensions> local;
+  sequential_for_iterate<Dimensions,
+                         range<Dimensions>,
+                         decltype(reconstruct_item),
+                         id<Dimensions>>{g.get_local_range(),
+                                         reconstruct_item,
+                                         local};
+}
+
+/** Implement a variation of parallel_for to take into account a
+    nd_range<> for kernels not using any barrier
 
-  parallel_for_iterate(g.get_local_range(), reconstruct_item);
+    The work-groups are distributed by TBB and the work-items of a
+    work-group are executed as a plain loop by the same thread.
+*/
+template <int Dimensions = 1, typename ParallelForFunctor>
+void parallel_for_no_barrier(nd_range<Dimensions> r, ParallelForFunctor f)
+{
+  parallel_for_each_group(r, [&](const group<Dimensions> &g) {
+    parallel_for_workitem<Dimensions, nd_item<Dimensions>>(g, f);
+  });
 }
 
-/// Implement a variation of parallel_for to take into account a nd_range<>
+/** Implement a variation of parallel_for to take into account a nd_range<>
+
+    Barriers are only supported with fibers, otherwise use the
+    barrier-free version
+*/
 template <int Dimensions = 1, typename ParallelForFunctor>
 void parallel_for(nd_range<Dimensions> r, ParallelForFunctor f)
 {
-  auto iterate_in_work_group = [&](id<Dimensions> g) {
-    trisycl::group<Dimensions> wg{g, r};
-    parallel_for_workitem<Dimensions, nd_item<Dimensions>, decltype(f)>(
-        wg, f);
-  };
-
-  parallel_for_iterate(r.get_group_range(), iterate_in_work_group);
+#if defined(TRISYCL_FIBER_BARRIER) && !defined(TRISYCL_NO_BARRIER)
+  parallel_for_each_group(r, [&](const group<Dimensions> &g) {
+    parallel_for_workitem_fiber<Dimensions, nd_item<Dimensions>>(g, f);
+  });
+#else
+  parallel_for_no_barrier(r, f);
+#endif
 }
 
 /// Implement the loop on the work-items inside a work-group
@@ -170,9 +400,64 @@ template <int Dimensions, typename ParallelForFunctor>
 void parallel_for_workitem_in_group(const group<Dimensions> &g,
                                     ParallelForFunctor f)
 {
-  parallel_for_workitem<Dimensions,
-                        h_item<Dimensions>,
-                        ParallelForFunctor>(g, f);
+  parallel_for_workitem<Dimensions, h_item<Dimensions>>(g, f);
+}
+
+/** Implement a parallel_for on a range<> with a reduction
+
+    Each TBB task accumulates its sub-range into a private reducer and
+    the partial results are combined by the TBB reduction tree.
+*/
+template <int Dimensions, typename Reduction, typename ParallelForFunctor>
+void parallel_for_reduce(range<Dimensions> r,
+                         Reduction red,
+                         ParallelForFunctor f)
+{
+  using T = typename Reduction::value_type;
+  auto result = tbb::parallel_reduce(
+      to_tbb_range(r),
+      Reduction::partial(red.make_reducer()),
+      [&](const auto &sub, const T &partial) {
+        auto reducer = red.make_reducer();
+        reducer.combine(partial);
+        for_each_point(sub, [&](const id<Dimensions> &index) {
+          call_reduction_kernel(f, r, index, reducer);
+        });
+        return Reduction::partial(reducer);
+      },
+      red.get_combiner());
+  red.commit(result);
+}
+
+/** Implement a parallel_for on a nd_range<> with a reduction
+
+    The work-items of a work-group share a reducer, which is combined
+    at the end of the work-group into the partial result of the TBB
+    thread running it. The partial results of the threads are then
+    combined with a tree.
+*/
+template <int Dimensions, typename Reduction, typename ParallelForFunctor>
+void parallel_for_reduce(nd_range<Dimensions> r,
+                         Reduction red,
+                         ParallelForFunctor f)
+{
+  reduction_partials partials{
+      std::min(std::size_t(tbb::this_task_arena::max_concurrency()),
+               max_local_memory_slots),
+      Reduction::partial(red.make_reducer()),
+      red.get_combiner()};
+  parallel_for_each_group(r, [&](const group<Dimensions> &g) {
+    auto reducer = red.make_reducer();
+    auto kernel = [&](nd_item<Dimensions> index) { f(index, reducer); };
+#if defined(TRISYCL_FIBER_BARRIER) && !defined(TRISYCL_NO_BARRIER)
+    parallel_for_workitem_fiber<Dimensions, nd_item<Dimensions>>(g, kernel);
+#else
+    parallel_for_workitem<Dimensions, nd_item<Dimensions>>(g, kernel);
+#endif
+    // The thread running the work-group is identified by its slot
+    partials.combine(local_memory_slot, Reduction::partial(reducer));
+  });
+  red.commit(partials.tree_combine());
 }
 
 /// @} End the parallelism Doxygen group
@@ -0,0 +1,206 @@
+#ifndef TRISYCL_SYCL_PARALLELISM_DETAIL_THREAD_BUDGET_HPP
+#define TRISYCL_SYCL_PARALLELISM_DETAIL_THREAD_BUDGET_HPP
+
+/** \file The thread budget shared by the kernels running concurrently
+
+    This file is distributed under the University of Illinois Open Source
+    License. See LICENSE.TXT for details.
+*/
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <thread>
+#include <utility>
+
+#ifdef TRISYCL_TBB
+#include <tbb/task_arena.h>
+#endif
+
+#include "triSYCL/detail/debug.hpp"
+#include "triSYCL/detail/singleton.hpp"
+
+/** \addtogroup parallelism
+    @{
+*/
+
+namespace trisycl::detail {
+
+/** A process-wide budget of threads for the parallel kernel engines
+
+    Since each running kernel opens its own parallel region, several
+    kernels running concurrently would each use all the cores. Instead
+    a starting kernel takes its share of the budget among the kernels
+    running, within the threads not used by the other kernels, which
+    gives the size of the thread team of its parallel loops. The share
+    is given back when the kernel ends.
+
+    So the teams never use more threads than the budget. A kernel
+    starting when the whole budget is in use still runs, but only on
+    the thread executing it.
+
+    The OpenMP engine sizes its parallel regions with team_size() and
+    the TBB engine runs a kernel with a smaller team in its own task
+    arena.
+*/
+class thread_budget : public detail::singleton<thread_budget>,
+                      public detail::debug<thread_budget> {
+
+  /// The total number of threads for all the running kernels
+  std::atomic<std::size_t> budget;
+
+  /// Number of kernels running
+  std::atomic<std::size_t> running { 0 };
+
+  /// Number of threads of the budget used by the running kernels
+  std::atomic<std::size_t> in_use { 0 };
+
+  /// The team size of the kernel run by this thread, 0 if none
+  static inline thread_local std::size_t team = 0;
+
+  /** The position in the budget of the share of the kernel run by
+      this thread, 0 if none */
+  static inline thread_local std::size_t offset = 0;
+
+  // Only the singleton can construct it
+  friend detail::singleton<thread_budget>;
+
+  /// By default use as many threads as hardware threads
+  thread_budget()
+    : budget { std::max<std::size_t>(1,
+                                     std::thread::hardware_concurrency()) }
+  {}
+
+public:
+
+  /** The share of the budget of a running kernel
+
+      It sets the team size of the parallel loops of the kernel run by
+      the current thread during its lifetime, and the position of its
+      share in the budget, after the threads used by the other kernels.
+  */
+  class share {
+    std::shared_ptr<thread_budget> b = thread_budget::instance();
+    std::size_t previous = team;
+    std::size_t previous_offset = offset;
+
+    /// The threads taken from the budget
+    std::size_t taken;
+
+  public:
+
+    share() {
+      auto kernels = ++b->running;
+      auto used = b->in_use.load();
+      do {
+        const std::size_t budget = b->budget;
+        const std::size_t free = used < budget ? budget - used : 0;
+        taken = std::min(budget/kernels, free);
+      } while (!b->in_use.compare_exchange_weak(used, used + taken));
+      team = std::max<std::size_t>(1, taken);
+      offset = used;
+    }
+
+    ~share() {
+      b->in_use -= taken;
+      --b->running;
+      team = previous;
+      offset = previous_offset;
+    }
+
+    share(const share &) = delete;
+    share &operator=(const share &) = delete;
+  };
+
+
+  /// Run a kernel with its share of the budget
+  template <typename Kernel>
+  static void run_kernel(Kernel &k) {
+    share s;
+#ifdef TRISYCL_TBB
+    if (team < std::size_t(tbb::this_task_arena::max_concurrency())) {
+      tbb::task_arena arena { int(team) };
+      arena.execute(k);
+      return;
+    }
+#endif
+    k();
+  }
+
+
+  /// Set the total number of threads for all the running kernels
+  void set_budget(std::size_t n) {
+    budget = std::max<std::size_t>(1, n);
+  }
+
+
+  /// Get the total number of threads for all the running kernels
+  std::size_t get_budget() const {
+    return budget;
+  }
+
+
+  /// Get the number of kernels running
+  std::size_t get_running_kernels() const {
+    return running;
+  }
+
+
+  /// Get the number of threads of the budget used by the running kernels
+  std::size_t get_threads_in_use() const {
+    return in_use;
+  }
+
+
+  /** Get the team size of the parallel loops run by the current thread
+
+      Outside of a kernel, such as in a direct call to the parallel
+      engine, the whole budget is used.
+  */
+  static std::size_t team_size() {
+    return team ? team : instance()->get_budget();
+  }
+
+
+  /** Get the position in the budget of the first thread of the team
+      of the parallel loops run by the current thread
+
+      This is 0 for a kernel running alone or outside of a kernel.
+  */
+  static std::size_t team_offset() {
+    return offset;
+  }
+
+
+  /** Get the contiguous chunk of [0, \param total) owned by the thread
+      \param thread of a team of \param threads threads
+
+      The remainder is distributed on the first threads so that the
+      chunk sizes differ at most by 1.
+
+      \return the begin and the end of the chunk
+  */
+  static std::pair<std::size_t, std::size_t>
+  static_chunk(std::size_t total, std::size_t threads, std::size_t thread) {
+    const std::size_t chunk = total / threads;
+    const std::size_t remainder = total % threads;
+    const std::size_t begin = thread*chunk + std::min(thread, remainder);
+    return { begin, begin + chunk + (thread < remainder) };
+  }
+
+};
+
+}
+
+/// @} End the parallelism Doxygen group
+
+/*
+    # Some Emacs stuff:
+    ### Local Variables:
+    ### ispell-local-dictionary: "american"
+    ### eval: (flyspell-prog-mode)
+    ### End:
+*/
+
+#endif // TRISYCL_SYCL_PARALLELISM_DETAIL_THREAD_BUDGET_HPP
@@ -0,0 +1,335 @@
+#ifndef TRISYCL_SYCL_PARALLELISM_DETAIL_WORK_GROUP_COLLECTIVE_HPP
+#define TRISYCL_SYCL_PARALLELISM_DETAIL_WORK_GROUP_COLLECTIVE_HPP
+
+/** \file
+
+    Exchange values between the work-items of a work-group for the
+    group collective algorithms, according to the host engine executing
+    the work-items
+
+    This file is distributed under the University of Illinois Open Source
+    License. See LICENSE.TXT for details.
+*/
+
+#include <atomic>
+#include <cstddef>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "triSYCL/detail/linear_id.hpp"
+#include "triSYCL/exception.hpp"
+#include "triSYCL/id.hpp"
+#include "triSYCL/range.hpp"
+#include "triSYCL/sub_group.hpp"
+
+/** \addtogroup parallelism
+    @{
+*/
+
+namespace trisycl::detail {
+
+/** The values exchanged by the work-items of a work-group executing a
+    collective algorithm
+
+    The work-items executed concurrently by a host engine, either as
+    fibers on a thread or as an OpenMP team, deposit their private
+    value and synchronize once with the engine barrier. Then the first
+    work-item computes the results of all the work-items in a single
+    sequential pass over the values, and after a second
+    synchronization each work-item picks its own result. So a
+    collective costs 2 barriers whatever the work-group size, instead
+    of the logarithmic number of barriers of a tree written with local
+    memory by the programmer.
+
+    The sub-group collectives work the same way but only the
+    work-items of the sub-group synchronize, with a counter, and the
+    leader of the sub-group computes its results, so the sub-groups of
+    a work-group can call different collectives or none at all. They
+    use their own storage, so they never overwrite the values of a
+    work-group collective in progress.
+*/
+class work_group_collective {
+
+public:
+
+  /// The largest value size exchanged by a collective, such as a double16
+  static constexpr std::size_t max_value_size = 128;
+
+private:
+
+  /// The collective state of the work-group run by the current thread
+  static inline thread_local work_group_collective *current = nullptr;
+
+  /// Number of work-items in the work-group
+  std::size_t size;
+
+  /// The barrier of the engine executing the work-group
+  void (*barrier)();
+
+  /// The rank of the work-item executed by the current thread
+  std::size_t (*rank)();
+
+  /** Wait while a value is equal to an old one, the value being
+      changed by another work-item of the work-group */
+  void (*wait_while_equal)(const std::atomic<std::size_t> &value,
+                           std::size_t old);
+
+  /// To allocate the storage only for the work-groups using collectives
+  std::once_flag allocated;
+
+  /** The storage of the values deposited by the work-items followed by
+      the storage of their results */
+  std::vector<std::max_align_t> storage;
+
+  /// The synchronization of the work-items of a sub-group
+  struct sub_group_barrier {
+    /// Number of work-items of the sub-group arrived at the barrier
+    std::atomic<std::size_t> arrived { 0 };
+
+    /// Incremented each time the work-items are released
+    std::atomic<std::size_t> generation { 0 };
+  };
+
+  /// To allocate the sub-group state only for the work-groups using it
+  std::once_flag sub_group_allocated;
+
+  /// The storage of the sub-group collectives, laid out as storage
+  std::vector<std::max_align_t> sub_group_storage;
+
+  /// The barrier of each sub-group
+  std::unique_ptr<sub_group_barrier[]> sub_group_barriers;
+
+
+  /// Get the slot of a work-item in the value or the result storage
+  template <typename T>
+  T *slots(bool results) {
+    auto base = reinterpret_cast<char *>(storage.data());
+    return reinterpret_cast<T *>(base + results*size*max_value_size);
+  }
+
+
+  /** Get the slots of a sub-group starting with the work-item of local
+      linear id \param first in the work-group
+
+      Each sub-group has its own slots of max_value_size bytes per
+      work-item, so the sub-groups can exchange values of different
+      types at the same time.
+  */
+  template <typename T>
+  T *sub_group_slots(bool results, std::size_t first) {
+    auto base = reinterpret_cast<char *>(sub_group_storage.data());
+    return reinterpret_cast<T *>(base
+                                 + (results*size + first)*max_value_size);
+  }
+
+
+  /// Wait for the \param n work-items of the sub-group \param s
+  void sub_group_wait(std::size_t s, std::size_t n) {
+    auto &b = sub_group_barriers[s];
+    const auto g = b.generation.load(std::memory_order_acquire);
+    if (b.arrived.fetch_add(1, std::memory_order_acq_rel) + 1 == n) {
+      // The last one arrived releases the others
+      b.arrived.store(0, std::memory_order_relaxed);
+      b.generation.fetch_add(1, std::memory_order_acq_rel);
+    }
+    else
+      wait_while_equal(b.generation, g);
+  }
+
+public:
+
+  /** Create the collective state of a work-group
+
+      \param[in] size is the number of work-items in the work-group
+
+      \param[in] barrier synchronizes the work-items of the work-group
+
+      \param[in] rank returns the rank in row-major order of the
+      work-item executed by the current thread
+
+      \param[in] wait_while_equal(value, old) returns once value has
+      been changed by another work-item, to synchronize a sub-group
+  */
+  work_group_collective(std::size_t size,
+                        void (*barrier)(),
+                        std::size_t (*rank)(),
+                        void (*wait_while_equal)
+                        (const std::atomic<std::size_t> &, std::size_t))
+    : size { size }
+    , barrier { barrier }
+    , rank { rank }
+    , wait_while_equal { wait_while_equal } {}
+
+
+  /// Make a collective state the one of the current thread in a scope
+  class scope {
+
+    work_group_collective *previous;
+
+  public:
+
+    scope(work_group_collective &c)
+      : previous { std::exchange(current, &c) } {}
+
+
+    ~scope() {
+      current = previous;
+    }
+
+  };
+
+
+  /** Exchange a value between all the work-items of a work-group
+
+      \param[in] size is the number of work-items in the work-group
+
+      \param[in] linear is the local linear id of the calling work-item
+
+      \param[in] x is the value of the calling work-item
+
+      \param[in] compute is called by only one work-item as
+      compute(values, results) to compute the results of all the
+      work-items from their values, both indexed by local linear id
+
+      \return the result computed for the calling work-item
+
+      \throw feature_not_supported if the work-items of a work-group
+      of more than 1 work-item are not executed concurrently by an
+      engine, as in the hierarchical kernels or with TRISYCL_NO_BARRIER,
+      which is an asynchronous error of the queue running the kernel
+  */
+  template <typename T, typename Compute>
+  static T exchange(std::size_t size,
+                    std::size_t linear,
+                    const T &x,
+                    Compute compute) {
+    static_assert(std::is_trivially_copyable_v<T>
+                  && sizeof(T) <= max_value_size
+                  && alignof(T) <= alignof(std::max_align_t),
+                  "Only small trivially copyable types can be exchanged "
+                  "by a group collective");
+    auto self = current;
+    if (!self) {
+      /* Without an engine executing the work-items concurrently, only
+         a work-group of 1 work-item can work */
+      if (size != 1)
+        throw feature_not_supported {
+          "Group collective without work-items executed concurrently" };
+      T result;
+      compute(&x, &result);
+      return result;
+    }
+    std::call_once(self->allocated, [&] {
+        self->storage.resize(2*self->size*max_value_size
+                             / sizeof(std::max_align_t));
+      });
+    std::memcpy(self->slots<T>(false) + linear, &x, sizeof(T));
+    self->barrier();
+    if (linear == 0)
+      compute(self->slots<const T>(false), self->slots<T>(true));
+    self->barrier();
+    T result;
+    std::memcpy(&result, self->slots<T>(true) + linear, sizeof(T));
+    return result;
+  }
+
+
+  /** Exchange a value between the work-items of a sub-group
+
+      Only the work-items of the sub-group synchronize.
+
+      \param[in] sg is the sub-group of the calling work-item
+
+      \param[in] x is the value of the calling work-item
+
+      \param[in] compute is called by the leader of the sub-group as
+      compute(values, results) to compute the results of the
+      work-items of the sub-group, indexed by local linear id in the
+      sub-group
+
+      \return the result computed for the calling work-item
+
+      \throw feature_not_supported if the work-items of a sub-group of
+      more than 1 work-item are not executed concurrently by an engine
+  */
+  template <typename T, typename Compute>
+  static T exchange(const sub_group &sg, const T &x, Compute compute) {
+    static_assert(std::is_trivially_copyable_v<T>
+                  && sizeof(T) <= max_value_size
+                  && alignof(T) <= alignof(std::max_align_t),
+                  "Only small trivially copyable types can be exchanged "
+                  "by a group collective");
+    const auto n = sg.get_local_linear_range();
+    auto self = current;
+    if (!self) {
+      if (n != 1)
+        throw feature_not_supported {
+          "Group collective without work-items executed concurrently" };
+      T result;
+      compute(&x, &result);
+      return result;
+    }
+    std::call_once(self->sub_group_allocated, [&] {
+        self->sub_group_storage.resize(2*self->size*max_value_size
+                                       / sizeof(std::max_align_t));
+        self->sub_group_barriers.reset(
+          new sub_group_barrier[sg.get_group_linear_range()]);
+      });
+    const auto s = sg.get_group_linear_id();
+    const auto first = s*sub_group::max_size;
+    std::memcpy(self->sub_group_slots<T>(false, first)
+                + sg.get_local_linear_id(), &x, sizeof(T));
+    self->sub_group_wait(s, n);
+    if (sg.leader())
+      compute(self->sub_group_slots<const T>(false, first),
+              self->sub_group_slots<T>(true, first));
+    self->sub_group_wait(s, n);
+    T result;
+    std::memcpy(&result, self->sub_group_slots<T>(true, first)
+                + sg.get_local_linear_id(), sizeof(T));
+    return result;
+  }
+
+
+  /** Exchange a value between all the work-items of a work-group,
+      the calling work-item being identified by the engine
+
+      \param[in] local_range is the local range of the work-group
+  */
+  template <int Dimensions, typename T, typename Compute>
+  static T exchange(const range<Dimensions> &local_range,
+                    const T &x,
+                    Compute compute) {
+    std::size_t linear = 0;
+    if (current) {
+      // Convert the row-major rank into the SYCL local linear id
+      auto r = current->rank();
+      id<Dimensions> local;
+      for (int d = Dimensions - 1; d >= 0; --d) {
+        local[d] = r % local_range[d];
+        r /= local_range[d];
+      }
+      linear = linear_id(local_range, local);
+    }
+    return exchange(local_range.size(), linear, x, compute);
+  }
+
+};
+
+/// @} End the parallelism Doxygen group
+
+}
+
+/*
+    # Some Emacs stuff:
+    ### Local Variables:
+    ### ispell-local-dictionary: "american"
+    ### eval: (flyspell-prog-mode)
+    ### End:
+*/
+
+#endif // TRISYCL_SYCL_PARALLELISM_DETAIL_WORK_GROUP_COLLECTIVE_HPP
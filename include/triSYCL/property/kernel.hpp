@@ -0,0 +1,158 @@
+#ifndef TRISYCL_SYCL_PROPERTY_KERNEL_HPP
+#define TRISYCL_SYCL_PROPERTY_KERNEL_HPP
+
+/** \file Properties for kernel launches.
+
+    This file is distributed under the University of Illinois Open Source
+    License. See LICENSE.TXT for details.
+*/
+
+#include <cstddef>
+
+#include "triSYCL/detail/property.hpp"
+#include "triSYCL/parallelism/detail/iteration_policy.hpp"
+
+namespace trisycl::property::kernel {
+
+/** Assert that a nd_range kernel never calls nd_item::barrier()
+
+    The work-items of a work-group do not need to run concurrently
+    then, so the work-groups can be executed in parallel, each one as
+    a simple loop on its work-items.
+
+    This is a triSYCL extension.
+*/
+class no_barrier : public detail::property {
+public:
+  no_barrier() {}
+};
+
+
+/** The base of the properties changing how the work-items of a
+    parallel_for on a range<> are iterated
+
+    Given to a queue, the properties are used by all its parallel_for
+    on a range<>. Given to a parallel_for, a property overrides only
+    the part of the queue iteration policy it is about.
+
+    This is a triSYCL extension.
+*/
+class iteration_property : public detail::property {
+public:
+  virtual ~iteration_property() = default;
+
+  /// Set the part of an iteration policy this property is about
+  virtual void apply(detail::iteration_policy &p) const = 0;
+};
+
+
+/** The base of the properties choosing the order in which the
+    work-items of a parallel_for on a range<> are iterated
+
+    The tile sizes are given from dimension 0, the sizes not given
+    being the last one given, and are clamped to the range.
+
+    This is a triSYCL extension.
+*/
+class iteration_order : public iteration_property {
+  detail::iteration_policy policy;
+
+protected:
+  iteration_order(detail::iteration_policy::order traversal,
+                  std::size_t t0, std::size_t t1, std::size_t t2)
+    : policy { traversal, { t0, t1, t2 } } {}
+
+public:
+  const detail::iteration_policy &get_policy() const { return policy; }
+
+  void apply(detail::iteration_policy &p) const override {
+    p.traversal = policy.traversal;
+    p.tile = policy.tile;
+  }
+};
+
+
+/** Iterate a range<> by tiles, distributed in row-major order
+
+    Each tile is executed by a single thread, so the neighbouring
+    work-items in every dimension share the cache.
+
+    This is a triSYCL extension.
+*/
+class tiled_iteration : public iteration_order {
+public:
+  tiled_iteration(std::size_t t0)
+    : iteration_order { detail::iteration_policy::order::tiled,
+                        t0, t0, t0 } {}
+
+  tiled_iteration(std::size_t t0, std::size_t t1)
+    : iteration_order { detail::iteration_policy::order::tiled,
+                        t0, t1, t1 } {}
+
+  tiled_iteration(std::size_t t0, std::size_t t1, std::size_t t2)
+    : iteration_order { detail::iteration_policy::order::tiled,
+                        t0, t1, t2 } {}
+};
+
+
+/** Iterate a range<> by tiles, distributed in Morton (Z) order
+
+    The consecutive tiles executed by a thread are close in every
+    dimension too.
+
+    This is a triSYCL extension.
+*/
+class morton_iteration : public iteration_order {
+public:
+  morton_iteration(std::size_t t0 = 8)
+    : iteration_order { detail::iteration_policy::order::morton,
+                        t0, t0, t0 } {}
+
+  morton_iteration(std::size_t t0, std::size_t t1)
+    : iteration_order { detail::iteration_policy::order::morton,
+                        t0, t1, t1 } {}
+
+  morton_iteration(std::size_t t0, std::size_t t1, std::size_t t2)
+    : iteration_order { detail::iteration_policy::order::morton,
+                        t0, t1, t2 } {}
+};
+
+
+/** Choose how the TBB engine splits a parallel_for on a range<> in
+    tasks
+
+    The grain is the minimum number of work-items of a task, to
+    amortize the task overhead on cheap kernels. With
+    kind::affinity, the repeated launches of a kernel reuse the thread
+    placement of the previous one to find their data still in cache.
+
+    The OpenMP engine always splits the iteration space evenly between
+    its threads and ignores this property.
+
+    This is a triSYCL extension.
+*/
+class partitioner : public iteration_property {
+public:
+  using kind = detail::iteration_policy::partitioner_kind;
+
+private:
+  kind partitioning;
+  std::size_t grain;
+
+public:
+  partitioner(kind partitioning, std::size_t grain = 1)
+    : partitioning { partitioning }, grain { grain } {}
+
+  kind get_kind() const { return partitioning; }
+
+  std::size_t get_grain() const { return grain; }
+
+  void apply(detail::iteration_policy &p) const override {
+    p.partitioner = partitioning;
+    p.grain = grain;
+  }
+};
+
+}
+
+#endif // TRISYCL_SYCL_PROPERTY_KERNEL_HPP
@@ -8,6 +8,11 @@
     This file is distributed under the University of Illinois Open Source
     License. See LICENSE.TXT for details.
 */
+
+#include <cstddef>
+
+#include "triSYCL/detail/property.hpp"
+
 namespace trisycl::property::queue {
 
 class enable_profiling : public detail::property {
@@ -15,6 +20,78 @@ public:
   enable_profiling() {}
 };
 
+
+/** Execute the command groups of the queue in submission order
+
+    Each command group simply waits for the previous one instead of
+    the command groups of the queue accessing the same buffers. The
+    accesses are still recorded in the buffers, so the command groups
+    of the other queues and the host accessors wait for them as
+    usual. While a buffer is used only by this queue, recording an
+    access is just replacing the previous one.
+*/
+class in_order : public detail::property {
+public:
+  in_order() {}
+};
+
+
+/** Number of worker threads the host executor starts eagerly
+
+    The executor is shared by all the queues of the process, so this
+    sizes it for all of them.
+
+    This is a triSYCL extension.
+*/
+class executor_concurrency : public detail::property {
+  std::size_t concurrency;
+
+public:
+  executor_concurrency(std::size_t concurrency)
+    : concurrency { concurrency } {}
+
+  std::size_t get_concurrency() const { return concurrency; }
+};
+
+
+/** Total number of threads used by the parallel loops of all the
+    kernels running concurrently
+
+    The budget is shared by all the queues of the process and divided
+    among the kernels running, each kernel taking its share from the
+    threads not used by the others when it starts. The host tasks do
+    not use the budget.
+
+    This is a triSYCL extension.
+*/
+class thread_budget : public detail::property {
+  std::size_t threads;
+
+public:
+  thread_budget(std::size_t threads) : threads { threads } {}
+
+  std::size_t get_threads() const { return threads; }
+};
+
+
+
+/** Pin the threads of the parallel loops of all the kernels on the
+    CPUs, so that the thread of a given index in any thread team runs
+    on the same CPU
+
+    The master thread of a team, which runs the kernel, is not pinned
+    and the kernels running concurrently use different CPUs.
+
+    Combined with numa_buffer_allocator, the kernels keep processing
+    the memory on their own NUMA node.
+
+    This is a triSYCL extension.
+*/
+class pin_threads : public detail::property {
+public:
+  pin_threads() {}
+};
+
 }
 
 #endif // TRISYCL_SYCL_PROPERTY_QUEUE_HPP
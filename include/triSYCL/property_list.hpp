@@ -1,7 +1,10 @@
 #ifndef TRISYCL_SYCL_PROPERTY_LIST_HPP
 #define TRISYCL_SYCL_PROPERTY_LIST_HPP
 
+#include <optional>
+
 #include "triSYCL/detail/all_true.hpp"
+#include "triSYCL/property/kernel.hpp"
 #include "triSYCL/property/queue.hpp"
 
 namespace trisycl {
@@ -18,6 +21,13 @@ class property_list {
    * property, this method is recursive to deal with the pack parameter.
    */
   TRISYCL_PROPERTY_CREATE(queue, enable_profiling);
+  TRISYCL_PROPERTY_CREATE(queue, in_order);
+  TRISYCL_PROPERTY_CREATE(queue, executor_concurrency);
+  TRISYCL_PROPERTY_CREATE(queue, thread_budget);
+  TRISYCL_PROPERTY_CREATE(queue, pin_threads);
+  TRISYCL_PROPERTY_CREATE(kernel, tiled_iteration);
+  TRISYCL_PROPERTY_CREATE(kernel, morton_iteration);
+  TRISYCL_PROPERTY_CREATE(kernel, partitioner);
 
 protected:
   template <typename propertyT>
@@ -31,6 +41,7 @@ private:
   template<typename T, typename... propsT,
            typename = std::enable_if_t<detail::all_true<std::is_convertible<propsT, detail::property>::value ...>::value>>
   void addproperty(T first, propsT... next) {
+    addproperty(first);
     addproperty(next...);
   }
 public:
@@ -61,6 +72,13 @@ public:
   }
 
 TRISYCL_PROPERTY_HAS_GET(queue, enable_profiling)
+TRISYCL_PROPERTY_HAS_GET(queue, in_order)
+TRISYCL_PROPERTY_HAS_GET(queue, executor_concurrency)
+TRISYCL_PROPERTY_HAS_GET(queue, thread_budget)
+TRISYCL_PROPERTY_HAS_GET(queue, pin_threads)
+TRISYCL_PROPERTY_HAS_GET(kernel, tiled_iteration)
+TRISYCL_PROPERTY_HAS_GET(kernel, morton_iteration)
+TRISYCL_PROPERTY_HAS_GET(kernel, partitioner)
 
 #undef TRISYCL_PROPERTY_CREATE
 #undef TRISYCL_PROPERTY_HAS_GET
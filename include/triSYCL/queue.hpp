@@ -15,9 +15,11 @@
 #include <boost/compute.hpp>
 #endif
 
+#include "triSYCL/command_graph.hpp"
 #include "triSYCL/context.hpp"
 #include "triSYCL/detail/debug.hpp"
 #include "triSYCL/detail/default_classes.hpp"
+#include "triSYCL/detail/numa.hpp"
 #include "triSYCL/detail/unimplemented.hpp"
 #include "triSYCL/detail/property.hpp"
 #include "triSYCL/device.hpp"
@@ -135,7 +137,10 @@ public:
 #else
     new detail::host_queue
 #endif
-  }, property_list { propList } { }
+  }, property_list { propList } {
+    implementation->handler = asyncHandler;
+    apply_properties();
+  }
 
   /** A queue is created for a SYCL device
 
@@ -171,6 +176,8 @@ public:
 #else
     std::shared_ptr<detail::queue>{ new detail::host_queue };
 #endif
+    implementation->handler = asyncHandler;
+    apply_properties();
   }
 
   /** This constructor chooses a device based on the provided
@@ -264,6 +271,12 @@ public:
   }
 
 
+  /// Return whether the command groups are executed in submission order
+  bool is_in_order() const {
+    return implementation->in_order;
+  }
+
+
   /** Performs a blocking wait for the completion all enqueued tasks in
       the queue
 
@@ -279,15 +292,15 @@ public:
       Synchronous errors will be reported via SYCL exceptions.
 
       Asynchronous errors will be passed to the async_handler passed to the
-      queue on construction.
+      queue on construction. The exceptions thrown by the kernels are
+      such asynchronous errors.
 
       If no async_handler was provided then asynchronous exceptions will
       be lost.
   */
   void wait_and_throw() {
-    // \todo Implement the throw part of wait_and_throw
     wait();
-    TRISYCL_UNIMPL;
+    throw_asynchronous();
   }
 
 
@@ -299,7 +312,7 @@ public:
       be lost.
   */
   void throw_asynchronous() {
-    TRISYCL_UNIMPL;
+    implementation->throw_asynchronous();
   }
 
 
@@ -320,7 +333,15 @@ public:
   event submit(Handler_Functor cgf) {
     handler command_group_handler { implementation };
     cgf(command_group_handler);
-    return {};
+    auto &t = command_group_handler.task;
+    if (t->recorded) {
+      /* The recorded command groups are not executed, so their events
+         are only useful to express the dependencies in the graph */
+      implementation->recording->add(t);
+      return { t };
+    }
+    // A command group without kernel has nothing to wait for
+    return t->scheduled ? event { t } : event {};
   }
 
 
@@ -340,6 +361,55 @@ public:
     return submit(cgf);
   }
 
+  /** Start recording the command groups submitted to this queue into
+      a command_graph instead of executing them
+
+      The events returned by the recorded submissions can only be used
+      by handler::depends_on() in the other command groups recorded in
+      the same graph. Waiting for them or using them in another
+      command group throws an invalid_object_error.
+
+      This is a triSYCL extension.
+  */
+  void begin_recording(command_graph &g) {
+    implementation->recording = g.implementation;
+  }
+
+
+  /** Stop recording the command groups submitted to this queue
+
+      This is a triSYCL extension.
+  */
+  void end_recording() {
+    implementation->recording = nullptr;
+  }
+
+
+  /** Submit the command groups recorded in a command_graph as a single
+      command group using all the buffers of the graph
+
+      This is a triSYCL extension.
+  */
+  event replay(const command_graph &g) {
+    if (implementation->recording)
+      throw invalid_object_error("Cannot replay a command_graph while "
+                                 "recording");
+    handler command_group_handler { implementation };
+    auto &t = command_group_handler.task;
+    for (auto &b : g.implementation->buffers)
+      t->add_buffer(b, g.implementation->histories.at(b->root()).written);
+    g.implementation->add_external_producers(*t);
+    // The last node of the graph completes the task
+    t->completed_by_kernel = true;
+    t->schedule([graph = g.implementation,
+                 replay = std::weak_ptr<detail::task> { t }] {
+        // The task is kept alive by the executor running it
+        detail::command_graph::execute(graph, replay.lock());
+      });
+    return { t };
+  }
+
+
   /** Check if the queue was constructed with the specified
       property.
   */
@@ -355,6 +425,34 @@ public:
   propertyT get_property() const {
     return property_list::get_property<propertyT>();
   }
+
+private:
+
+  /// Apply the properties having an effect on the runtime itself
+  void apply_properties() {
+    if (has_property<property::queue::in_order>())
+      implementation->in_order = true;
+    if (has_property<property::queue::enable_profiling>())
+      implementation->profiling = true;
+    if (has_property<property::queue::executor_concurrency>())
+      detail::executor::instance()->set_concurrency(
+        get_property<property::queue::executor_concurrency>()
+        .get_concurrency());
+    if (has_property<property::queue::thread_budget>())
+      detail::thread_budget::instance()->set_budget(
+        get_property<property::queue::thread_budget>().get_threads());
+    if (has_property<property::queue::pin_threads>())
+      detail::numa::instance()->set_pinning(true);
+    if (has_property<property::kernel::tiled_iteration>())
+      get_property<property::kernel::tiled_iteration>()
+        .apply(implementation->range_iteration);
+    if (has_property<property::kernel::morton_iteration>())
+      get_property<property::kernel::morton_iteration>()
+        .apply(implementation->range_iteration);
+    if (has_property<property::kernel::partitioner>())
+      get_property<property::kernel::partitioner>()
+        .apply(implementation->range_iteration);
+  }
 };
 
 template<>
@@ -11,7 +11,10 @@
 
 #include <atomic>
 #include <condition_variable>
+#include <exception>
+#include <memory>
 #include <mutex>
+#include <utility>
 
 #ifdef TRISYCL_OPENCL
 #include <boost/compute.hpp>
@@ -20,9 +23,14 @@
 #include "triSYCL/context.hpp"
 #include "triSYCL/device.hpp"
 #include "triSYCL/detail/debug.hpp"
+#include "triSYCL/exception.hpp"
+#include "triSYCL/parallelism/detail/iteration_policy.hpp"
 
 namespace trisycl::detail {
 
+struct command_graph;
+struct task;
+
 /** Some implementation details about the SYCL queue
  */
 struct queue : detail::debug<detail::queue> {
@@ -34,6 +42,35 @@ struct queue : detail::debug<detail::queue> {
   /// To protect the access to the condition variable
   std::mutex finished_mutex;
 
+  /** The iteration order of the parallel_for on a range<> without an
+      iteration property */
+  iteration_policy range_iteration;
+
+  /// The graph recording the command groups submitted, if any
+  std::shared_ptr<detail::command_graph> recording;
+
+  /// Whether the command groups are executed in submission order
+  bool in_order = false;
+
+  /// Whether the command groups record their profiling time stamps
+  bool profiling = false;
+
+  /** The latest task submitted to an in-order queue while it has not
+      completed
+
+      Only accessed with the atomic shared_ptr functions.
+  */
+  std::shared_ptr<detail::task> last_task;
+
+  /// The handler of the asynchronous errors, if any
+  async_handler handler;
+
+  /** The exceptions thrown by the kernels and not reported yet to the
+      handler */
+  exception_list async_errors;
+  /// To protect the access to the asynchronous errors
+  std::mutex async_errors_mutex;
+
 
   /// Initialize the queue with 0 running kernel
   queue() : running_kernels { 0 } {}
@@ -77,6 +114,28 @@ struct queue : detail::debug<detail::queue> {
   }
 
 
+  /// Keep an exception thrown by a kernel, to be reported later
+  void add_async_error(std::exception_ptr e) {
+    std::lock_guard<std::mutex> lg { async_errors_mutex };
+    async_errors.push_back(std::move(e));
+  }
+
+
+  /** Report the asynchronous errors not reported yet to the handler
+
+      Without a handler the errors are lost.
+  */
+  void throw_asynchronous() {
+    exception_list errors;
+    {
+      std::lock_guard<std::mutex> lg { async_errors_mutex };
+      errors.swap(async_errors);
+    }
+    if (!errors.empty() && handler)
+      handler(std::move(errors));
+  }
+
+
 #ifdef TRISYCL_OPENCL
   /** Return the underlying OpenCL command queue after doing a retain
 
@@ -0,0 +1,410 @@
+#ifndef TRISYCL_SYCL_REDUCTION_HPP
+#define TRISYCL_SYCL_REDUCTION_HPP
+
+/** \file The reductions of the parallel_for kernels
+
+    This is inspired by the SYCL 2020 reduction interface.
+
+    This file is distributed under the University of Illinois Open Source
+    License. See LICENSE.TXT for details.
+*/
+
+#include <algorithm>
+#include <cstddef>
+#include <functional>
+#include <limits>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "triSYCL/id.hpp"
+#include "triSYCL/item.hpp"
+#include "triSYCL/range.hpp"
+
+namespace trisycl {
+
+/** \addtogroup parallelism
+    @{
+*/
+
+/// A function object computing the minimum of 2 values
+template <typename T = void>
+struct minimum {
+  T operator()(const T &x, const T &y) const {
+    return std::min(x, y);
+  }
+};
+
+
+/// A transparent function object computing the minimum of 2 values
+template <>
+struct minimum<void> {
+  template <typename T>
+  T operator()(const T &x, const T &y) const {
+    return std::min(x, y);
+  }
+};
+
+
+/// A function object computing the maximum of 2 values
+template <typename T = void>
+struct maximum {
+  T operator()(const T &x, const T &y) const {
+    return std::max(x, y);
+  }
+};
+
+
+/// A transparent function object computing the maximum of 2 values
+template <>
+struct maximum<void> {
+  template <typename T>
+  T operator()(const T &x, const T &y) const {
+    return std::max(x, y);
+  }
+};
+
+
+namespace detail {
+
+/** Test whether BinaryOperation is the function object template
+    Operation, either for T or transparent */
+template <typename BinaryOperation,
+          template <typename> typename Operation,
+          typename T>
+inline constexpr bool is_operation_v =
+  std::is_same_v<BinaryOperation, Operation<T>>
+  || std::is_same_v<BinaryOperation, Operation<void>>;
+
+}
+
+
+/** The identity of a combiner for a type, when it is known by the
+    implementation
+
+    value is only defined when has_known_identity<...>::value is true.
+*/
+template <typename BinaryOperation, typename T, typename = void>
+struct known_identity {};
+
+
+/// The sum and the bitwise or and xor start from 0
+template <typename BinaryOperation, typename T>
+struct known_identity<BinaryOperation, T, std::enable_if_t<
+  detail::is_operation_v<BinaryOperation, std::plus, T>
+  || (std::is_integral_v<T>
+      && (detail::is_operation_v<BinaryOperation, std::bit_or, T>
+          || detail::is_operation_v<BinaryOperation, std::bit_xor, T>))>> {
+  static constexpr T value = T {};
+};
+
+
+/// The product starts from 1
+template <typename BinaryOperation, typename T>
+struct known_identity<BinaryOperation, T, std::enable_if_t<
+  detail::is_operation_v<BinaryOperation, std::multiplies, T>>> {
+  static constexpr T value = T { 1 };
+};
+
+
+/// The bitwise and starts with all the bits set
+template <typename BinaryOperation, typename T>
+struct known_identity<BinaryOperation, T, std::enable_if_t<
+  std::is_integral_v<T>
+  && detail::is_operation_v<BinaryOperation, std::bit_and, T>>> {
+  static constexpr T value = static_cast<T>(~T {});
+};
+
+
+/// The minimum starts from the largest value
+template <typename BinaryOperation, typename T>
+struct known_identity<BinaryOperation, T, std::enable_if_t<
+  std::numeric_limits<T>::is_specialized
+  && detail::is_operation_v<BinaryOperation, minimum, T>>> {
+  static constexpr T value = std::numeric_limits<T>::has_infinity
+    ? std::numeric_limits<T>::infinity() : std::numeric_limits<T>::max();
+};
+
+
+/// The maximum starts from the lowest value
+template <typename BinaryOperation, typename T>
+struct known_identity<BinaryOperation, T, std::enable_if_t<
+  std::numeric_limits<T>::is_specialized
+  && detail::is_operation_v<BinaryOperation, maximum, T>>> {
+  static constexpr T value = std::numeric_limits<T>::has_infinity
+    ? -std::numeric_limits<T>::infinity() : std::numeric_limits<T>::lowest();
+};
+
+
+/// Test whether the identity of a combiner for a type is known
+template <typename BinaryOperation, typename T, typename = void>
+struct has_known_identity : std::false_type {};
+
+
+template <typename BinaryOperation, typename T>
+struct has_known_identity<BinaryOperation, T,
+                          std::void_t<decltype(known_identity<BinaryOperation,
+                                                              T>::value)>>
+  : std::true_type {};
+
+
+template <typename BinaryOperation, typename T>
+inline constexpr bool has_known_identity_v =
+  has_known_identity<BinaryOperation, T>::value;
+
+
+namespace detail {
+
+template <typename Target, typename T, typename BinaryOperation>
+class reduction;
+
+}
+
+
+/** The partial result of a reduction accumulated by a work-item
+
+    A reducer is passed by reference to the kernel as the last
+    argument and is private to the executing thread, so there is no
+    synchronization at all on the accumulation.
+*/
+template <typename T, typename BinaryOperation>
+class reducer {
+
+  /// The partial result
+  T value;
+
+  /// The combination function
+  BinaryOperation combiner;
+
+  template <typename, typename, typename>
+  friend class detail::reduction;
+
+  reducer(const T &identity, const BinaryOperation &combiner)
+    : value { identity }, combiner { combiner } {}
+
+public:
+
+  /// Combine a new value with the partial result
+  void combine(const T &partial) {
+    value = combiner(value, partial);
+  }
+
+
+  /// Shorthand for combine() with std::plus
+  void operator+=(const T &partial) {
+    static_assert(detail::is_operation_v<BinaryOperation, std::plus, T>,
+                  "operator+= requires a std::plus reduction");
+    combine(partial);
+  }
+
+
+  /// Shorthand for combine(1) with std::plus
+  void operator++() {
+    *this += T { 1 };
+  }
+
+
+  /// Shorthand for combine() with std::multiplies
+  void operator*=(const T &partial) {
+    static_assert(detail::is_operation_v<BinaryOperation, std::multiplies, T>,
+                  "operator*= requires a std::multiplies reduction");
+    combine(partial);
+  }
+
+
+  /// Shorthand for combine() with std::bit_and
+  void operator&=(const T &partial) {
+    static_assert(detail::is_operation_v<BinaryOperation, std::bit_and, T>,
+                  "operator&= requires a std::bit_and reduction");
+    combine(partial);
+  }
+
+
+  /// Shorthand for combine() with std::bit_or
+  void operator|=(const T &partial) {
+    static_assert(detail::is_operation_v<BinaryOperation, std::bit_or, T>,
+                  "operator|= requires a std::bit_or reduction");
+    combine(partial);
+  }
+
+
+  /// Shorthand for combine() with std::bit_xor
+  void operator^=(const T &partial) {
+    static_assert(detail::is_operation_v<BinaryOperation, std::bit_xor, T>,
+                  "operator^= requires a std::bit_xor reduction");
+    combine(partial);
+  }
+
+};
+
+
+namespace detail {
+
+/** The description of a reduction given to a parallel_for
+
+    \param Target is an accessor or a pointer to the variable
+    receiving the result, combined with its initial value
+*/
+template <typename Target, typename T, typename BinaryOperation>
+class reduction {
+
+  /// Where the result goes
+  Target target;
+
+  /// The identity of the combiner
+  T identity;
+
+  /// The combination function
+  BinaryOperation combiner;
+
+public:
+
+  using value_type = T;
+
+  using reducer_type = reducer<T, BinaryOperation>;
+
+  reduction(Target target,
+            const T &identity,
+            const BinaryOperation &combiner)
+    : target { target }, identity { identity }, combiner { combiner } {}
+
+
+  /// Create a reducer with a private partial result to accumulate into
+  reducer_type make_reducer() const {
+    return { identity, combiner };
+  }
+
+
+  /// Get the partial result accumulated by a reducer
+  static const T &partial(const reducer_type &r) {
+    return r.value;
+  }
+
+
+  /// Get the combination function
+  const BinaryOperation &get_combiner() const {
+    return combiner;
+  }
+
+
+  /** Combine the final value into the target
+
+      This is only called once, after all the work-items have ended.
+  */
+  void commit(const T &result) const {
+    auto &variable = *target;
+    variable = combiner(variable, result);
+  }
+
+};
+
+
+/** The partial results of a reduction, one per thread executing the
+    kernel
+
+    Each partial result lives on its own cache line to avoid false
+    sharing between the threads.
+*/
+template <typename T, typename BinaryOperation>
+class reduction_partials {
+
+  struct alignas(std::max<std::size_t>(64, alignof(T))) partial {
+    T value;
+  };
+
+  std::vector<partial> partials;
+
+  BinaryOperation combiner;
+
+public:
+
+  /// Create the partials of n threads starting from the identity
+  reduction_partials(std::size_t n,
+                     const T &identity,
+                     const BinaryOperation &combiner)
+    : partials(std::max<std::size_t>(n, 1), partial { identity })
+    , combiner { combiner } {}
+
+
+  /// Combine a value into the partial of a thread
+  void combine(std::size_t thread, const T &value) {
+    auto &p = partials[thread].value;
+    p = combiner(p, value);
+  }
+
+
+  /** Combine all the partials with a pairwise tree to have a
+      logarithmic dependence chain instead of a linear one */
+  T tree_combine() {
+    const auto n = partials.size();
+    for (std::size_t stride = 1; stride < n; stride *= 2)
+      for (std::size_t i = 0; i + stride < n; i += 2*stride)
+        partials[i].value = combiner(partials[i].value,
+                                     partials[i + stride].value);
+    return partials[0].value;
+  }
+
+};
+
+
+/** Call a reduction kernel on a range<> with either an id<> or an
+    item<> according to what it accepts */
+template <int Dimensions, typename ParallelForFunctor, typename Reducer>
+void call_reduction_kernel(ParallelForFunctor &f,
+                           const range<Dimensions> &r,
+                           const id<Dimensions> &index,
+                           Reducer &reducer) {
+  if constexpr (std::is_invocable_v<ParallelForFunctor &,
+                                    id<Dimensions>,
+                                    Reducer &>)
+    f(index, reducer);
+  else
+    f(item<Dimensions> { r, index }, reducer);
+}
+
+}
+
+
+/** Create a reduction into the first element of an accessor, or into
+    the variable pointed to by a pointer, with a combiner for which the
+    identity is known
+
+    The kernel passed to parallel_for receives a reducer as its last
+    argument and the result is combined with the initial value of the
+    variable.
+*/
+template <typename Accessor, typename BinaryOperation>
+auto reduction(Accessor acc, BinaryOperation combiner) {
+  using T = std::decay_t<decltype(*acc)>;
+  static_assert(has_known_identity_v<BinaryOperation, T>,
+                "The identity has to be given for this combiner");
+  return detail::reduction<Accessor, T, BinaryOperation> {
+    acc, known_identity<BinaryOperation, T>::value, combiner
+  };
+}
+
+
+/** Create a reduction into the first element of an accessor, or into
+    the variable pointed to by a pointer, with a user combiner and its
+    identity */
+template <typename Accessor, typename T, typename BinaryOperation>
+auto reduction(Accessor acc, const T &identity, BinaryOperation combiner) {
+  using V = std::decay_t<decltype(*acc)>;
+  return detail::reduction<Accessor, V, BinaryOperation> {
+    acc, identity, combiner
+  };
+}
+
+/// @} End the parallelism Doxygen group
+
+}
+
+/*
+    # Some Emacs stuff:
+    ### Local Variables:
+    ### ispell-local-dictionary: "american"
+    ### eval: (flyspell-prog-mode)
+    ### End:
+*/
+
+#endif // TRISYCL_SYCL_REDUCTION_HPP
@@ -0,0 +1,168 @@
+#ifndef TRISYCL_SYCL_SUB_GROUP_HPP
+#define TRISYCL_SYCL_SUB_GROUP_HPP
+
+/** \file The sub-group of a work-item in a work-group
+
+    This is inspired by the SYCL 2020 sub_group interface.
+
+    This file is distributed under the University of Illinois Open Source
+    License. See LICENSE.TXT for details.
+*/
+
+#include <algorithm>
+#include <cstddef>
+
+#include "triSYCL/id.hpp"
+#include "triSYCL/range.hpp"
+
+/** The number of work-items in a sub-group
+
+    By default it is the number of 32-bit lanes of the widest vector
+    registers the host code is compiled for, so that the work-items of
+    a sub-group map onto the lanes of a vector register.
+*/
+#ifndef TRISYCL_SUB_GROUP_SIZE
+#if defined(__AVX512F__)
+#define TRISYCL_SUB_GROUP_SIZE 16
+#elif defined(__AVX__)
+#define TRISYCL_SUB_GROUP_SIZE 8
+#else
+#define TRISYCL_SUB_GROUP_SIZE 4
+#endif
+#endif
+
+namespace trisycl {
+
+/** \addtogroup parallelism
+    @{
+*/
+
+/** A sub-group is a set of consecutive work-items of a work-group in
+    local linear id order
+
+    All the sub-groups have TRISYCL_SUB_GROUP_SIZE work-items, except
+    the last one of a work-group when the work-group size is not a
+    multiple of it.
+*/
+class sub_group {
+
+public:
+
+  static constexpr int dimensionality = 1;
+
+  using id_type = id<1>;
+
+  using range_type = range<1>;
+
+  using linear_id_type = std::size_t;
+
+  /// The number of work-items in a full sub-group
+  static constexpr std::size_t max_size = TRISYCL_SUB_GROUP_SIZE;
+
+private:
+
+  /// Number of work-items in the work-group
+  std::size_t work_group_size;
+
+  /// The local linear id of the work-item in its work-group
+  std::size_t work_group_linear_id;
+
+public:
+
+  /** Create the sub-group of a work-item
+
+      This is used by the triSYCL implementation.
+  */
+  sub_group(std::size_t work_group_size, std::size_t work_group_linear_id)
+    : work_group_size { work_group_size }
+    , work_group_linear_id { work_group_linear_id } {}
+
+
+  /// Get the index of the sub-group in the work-group
+  id<1> get_group_id() const {
+    return work_group_linear_id / max_size;
+  }
+
+
+  /// Get the index of the work-item in the sub-group
+  id<1> get_local_id() const {
+    return work_group_linear_id % max_size;
+  }
+
+
+  /// Get the number of work-items in this sub-group
+  range<1> get_local_range() const {
+    return std::min(max_size, work_group_size - get_group_id()[0]*max_size);
+  }
+
+
+  /// Get the number of work-items in a full sub-group
+  range<1> get_max_local_range() const {
+    return max_size;
+  }
+
+
+  /// Get the number of sub-groups in the work-group
+  range<1> get_group_range() const {
+    return (work_group_size + max_size - 1) / max_size;
+  }
+
+
+  std::size_t get_group_linear_id() const {
+    return get_group_id()[0];
+  }
+
+
+  std::size_t get_local_linear_id() const {
+    return get_local_id()[0];
+  }
+
+
+  std::size_t get_group_linear_range() const {
+    return get_group_range()[0];
+  }
+
+
+  std::size_t get_local_linear_range() const {
+    return get_local_range()[0];
+  }
+
+
+  /// Test whether the work-item is the first one of its sub-group
+  bool leader() const {
+    return get_local_linear_id() == 0;
+  }
+
+
+  /** Get the number of work-items in the work-group
+
+      This is used by the triSYCL implementation.
+  */
+  std::size_t get_work_group_size() const {
+    return work_group_size;
+  }
+
+
+  /** Get the local linear id of the work-item in its work-group
+
+      This is used by the triSYCL implementation.
+  */
+  std::size_t get_work_group_linear_id() const {
+    return work_group_linear_id;
+  }
+
+};
+
+/// @} End the parallelism Doxygen group
+
+}
+
+/*
+    # Some Emacs stuff:
+    ### Local Variables:
+    ### ispell-local-dictionary: "american"
+    ### eval: (flyspell-prog-mode)
+    ### End:
+*/
+
+#endif // TRISYCL_SYCL_SUB_GROUP_HPP
@@ -57,6 +57,7 @@
 #include "triSYCL/event.hpp"
 #include "triSYCL/exception.hpp"
 #include "triSYCL/group.hpp"
+#include "triSYCL/group_algorithm.hpp"
 #include "triSYCL/half.hpp"
 #include "triSYCL/handler.hpp"
 #include "triSYCL/h_item.hpp"
@@ -74,7 +75,9 @@
 #include "triSYCL/program.hpp"
 #include "triSYCL/queue.hpp"
 #include "triSYCL/range.hpp"
+#include "triSYCL/reduction.hpp"
 #include "triSYCL/static_pipe.hpp"
+#include "triSYCL/sub_group.hpp"
 #include "triSYCL/vec.hpp"
 
 // Some includes at the end to break some dependencies
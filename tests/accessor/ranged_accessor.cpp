@@ -0,0 +1,89 @@
+/* RUN: %{execute}%s
+
+   Check the accessors to a part of a buffer: they are indexed relatively
+   to their offset and the kernels writing disjoint parts of the same
+   buffer run concurrently
+*/
+#include <CL/sycl.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+#include <boost/test/minimal.hpp>
+
+using namespace cl::sycl;
+using namespace std::chrono_literals;
+
+constexpr size_t M = 4;
+constexpr size_t N = 8;
+
+int test_main(int argc, char *argv[]) {
+  // Have enough workers to run the writers concurrently
+  queue q { property_list { property::queue::executor_concurrency { 4 } } };
+  buffer<int, 2> a { range<2> { M, N } };
+
+  // 2 writers of the halves which can only complete if they run at the
+  // same time
+  std::atomic<int> running_writers { 0 };
+  std::atomic<bool> concurrent_writers[2] = { false, false };
+  for (int h = 0; h < 2; ++h)
+    q.submit([&, h](handler &cgh) {
+        auto w = a.get_access<access::mode::discard_write>
+          (cgh, range<2> { M/2, N }, id<2> { h*M/2, 0 });
+        BOOST_CHECK(w.get_range() == (range<2> { M/2, N }));
+        BOOST_CHECK(w.get_offset() == (id<2> { h*M/2, 0 }));
+        BOOST_CHECK(w.get_count() == M/2*N);
+        cgh.single_task([=, &running_writers, &concurrent_writers] {
+            ++running_writers;
+            for (auto deadline = std::chrono::steady_clock::now() + 10s;
+                 running_writers < 2
+                   && std::chrono::steady_clock::now() < deadline;)
+              std::this_thread::yield();
+            concurrent_writers[h] = running_writers >= 2;
+            // Let the next kernel start too early if it does not wait
+            std::this_thread::sleep_for(50ms);
+            for (size_t i = 0; i < M/2; ++i)
+              for (size_t j = 0; j < N; ++j)
+                w[i][j] = h + 1;
+          });
+      });
+
+  // This kernel on the middle rows has to wait for both the writers
+  q.submit([&](handler &cgh) {
+      accessor<int, 2, access::mode::read_write, access::target::global_buffer>
+        w { a, cgh, range<2> { 2, N - 2 }, id<2> { M/2 - 1, 1 } };
+      cgh.parallel_for(range<2> { 2, N - 2 }, [=] (id<2> i) {
+          w[i] *= 10;
+        });
+    });
+  q.wait();
+  BOOST_CHECK(concurrent_writers[0] && concurrent_writers[1]);
+
+  {
+    // A host accessor on the last row
+    auto last = a.get_access<access::mode::read>(range<2> { 1, N },
+                                                 id<2> { M - 1, 0 });
+    for (size_t j = 0; j < N; ++j)
+      BOOST_CHECK(last[0][j] == 2);
+  }
+  auto aa = a.get_access<access::mode::read>();
+  for (size_t i = 0; i < M; ++i)
+    for (size_t j = 0; j < N; ++j) {
+      int expected = 1 + i/(M/2);
+      if (i >= M/2 - 1 && i <= M/2 && j >= 1 && j < N - 1)
+        expected *= 10;
+      BOOST_CHECK(aa[i][j] == expected);
+    }
+
+  // The accessed part has to be inside the buffer
+  bool thrown = false;
+  try {
+    a.get_access<access::mode::read>(range<2> { 2, N }, id<2> { M - 1, 0 });
+  } catch (const exception &) {
+    thrown = true;
+  }
+  BOOST_CHECK(thrown);
+
+  return 0;
+}
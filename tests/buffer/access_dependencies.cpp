@@ -0,0 +1,73 @@
+/* RUN: %{execute}%s
+
+   Check the dependencies between kernels accessing the same buffer:
+   the readers run concurrently and a writer waits for the previous
+   readers (write-after-read) as well as for the previous writer
+*/
+#include <CL/sycl.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+#include <boost/test/minimal.hpp>
+
+using namespace cl::sycl;
+using namespace std::chrono_literals;
+
+constexpr size_t N = 16;
+
+int test_main(int argc, char *argv[]) {
+  // Have enough workers to run the readers concurrently
+  queue q { property_list { property::queue::executor_concurrency { 4 } } };
+  buffer<int> a { N };
+  buffer<int> copies[2] = { buffer<int> { N }, buffer<int> { N } };
+  q.submit([&](handler &cgh) {
+      auto w = a.get_access<access::mode::discard_write>(cgh);
+      cgh.parallel_for(range<1> { N }, [=] (id<1> i) { w[i] = 1; });
+    });
+
+  // 2 readers which can only complete if they run at the same time
+  std::atomic<int> running_readers { 0 };
+  std::atomic<bool> concurrent_readers[2] = { false, false };
+  for (int r = 0; r < 2; ++r)
+    q.submit([&, r](handler &cgh) {
+        auto in = a.get_access<access::mode::read>(cgh);
+        auto out = copies[r].get_access<access::mode::write>(cgh);
+        cgh.single_task([=, &running_readers, &concurrent_readers] {
+            ++running_readers;
+            for (auto deadline = std::chrono::steady_clock::now() + 10s;
+                 running_readers < 2
+                   && std::chrono::steady_clock::now() < deadline;)
+              std::this_thread::yield();
+            concurrent_readers[r] = running_readers >= 2;
+            // Let the next writer overwrite too early if it does not wait
+            std::this_thread::sleep_for(50ms);
+            for (size_t i = 0; i < N; ++i)
+              out[i] = in[i];
+          });
+      });
+
+  // This writer has to wait for both the readers
+  q.submit([&](handler &cgh) {
+      auto w = a.get_access<access::mode::write>(cgh);
+      cgh.parallel_for(range<1> { N }, [=] (id<1> i) { w[i] = 2; });
+    });
+  // And this one for the previous writer
+  q.submit([&](handler &cgh) {
+      auto w = a.get_access<access::mode::read_write>(cgh);
+      cgh.parallel_for(range<1> { N }, [=] (id<1> i) { w[i] *= 3; });
+    });
+  q.wait();
+
+  BOOST_CHECK(concurrent_readers[0] && concurrent_readers[1]);
+  auto c0 = copies[0].get_access<access::mode::read>();
+  auto c1 = copies[1].get_access<access::mode::read>();
+  auto v = a.get_access<access::mode::read>();
+  for (size_t i = 0; i < N; ++i) {
+    BOOST_CHECK(c0[i] == 1);
+    BOOST_CHECK(c1[i] == 1);
+    BOOST_CHECK(v[i] == 6);
+  }
+  return 0;
+}
@@ -0,0 +1,39 @@
+/* RUN: %{execute}%s
+
+   Check the alignment of the buffers allocated with the aligned and
+   huge page buffer allocators
+*/
+#include <CL/sycl.hpp>
+
+#include <cstdint>
+
+#include <boost/test/minimal.hpp>
+
+using namespace cl::sycl;
+
+/// Fill a buffer with a kernel and return its memory address
+template <typename Allocator>
+std::uintptr_t fill(queue &q, std::size_t n) {
+  buffer<float, 1, Allocator> b { n };
+  q.submit([&] (handler &cgh) {
+      auto w = b.template get_access<access::mode::discard_write>(cgh);
+      cgh.parallel_for(range<1> { n }, [=] (id<1> i) { w[i] = i[0]; });
+    });
+  auto r = b.template get_access<access::mode::read>();
+  BOOST_CHECK(r[0] == 0 && r[n - 1] == n - 1);
+  return reinterpret_cast<std::uintptr_t>(&r[0]);
+}
+
+
+int test_main(int argc, char *argv[]) {
+  queue q;
+  BOOST_CHECK(fill<aligned_buffer_allocator<float>>(q, 1001) % 64 == 0);
+  BOOST_CHECK((fill<aligned_buffer_allocator<float, 4096>>(q, 3) % 4096 == 0));
+  // A small buffer is only aligned on a cache line
+  BOOST_CHECK(fill<huge_page_buffer_allocator<float>>(q, 1001) % 64 == 0);
+  // A large one is aligned on a huge page, whatever the kind of page
+  BOOST_CHECK(fill<huge_page_buffer_allocator<float>>(q, 3 << 20)
+              % (2 << 20) == 0);
+
+  return 0;
+}
@@ -0,0 +1,56 @@
+/* RUN: %{execute}%s
+
+   Check that writing to a buffer built from const host data only
+   copies the pages accessed: the pages of the host data outside of the
+   accessors are made unreadable until the final host accessor
+*/
+#include <CL/sycl.hpp>
+
+#include <sys/mman.h>
+
+#include <boost/test/minimal.hpp>
+
+using namespace cl::sycl;
+
+constexpr size_t N = 1 << 20;
+
+int test_main(int argc, char *argv[]) {
+  queue q;
+  auto bytes = N*sizeof(int);
+  auto data = static_cast<int *>(::mmap(nullptr, bytes,
+                                        PROT_READ | PROT_WRITE,
+                                        MAP_PRIVATE | MAP_ANONYMOUS, -1, 0));
+  BOOST_CHECK(data != MAP_FAILED);
+  for (size_t i = 0; i < N; ++i)
+    data[i] = i;
+  // Any access to the second half crashes from now
+  ::mprotect(data + N/2, bytes/2, PROT_NONE);
+
+  {
+    buffer<int> b { static_cast<const int *>(data), N };
+    q.submit([&] (handler &cgh) {
+        auto a = b.get_access<access::mode::read_write>(cgh, range<1> { 1000 },
+                                                        id<1> { 10 });
+        cgh.parallel_for(range<1> { 1000 }, [=] (id<1> i) { a[i] *= 2; });
+      });
+    // Writing without reading the previous content does not read it
+    q.submit([&] (handler &cgh) {
+        auto a = b.get_access<access::mode::discard_write>
+          (cgh, range<1> { N/2 }, id<1> { N/2 });
+        cgh.parallel_for(range<1> { N/2 }, [=] (id<1> i) { a[i] = -1; });
+      });
+    q.wait();
+
+    ::mprotect(data + N/2, bytes/2, PROT_READ | PROT_WRITE);
+    auto a = b.get_access<access::mode::read>();
+    for (size_t i = 0; i < N; ++i)
+      BOOST_CHECK(a[i] == (i >= N/2 ? -1
+                           : static_cast<int>(i >= 10 && i < 1010 ? 2*i : i)));
+  }
+  // The host data are never modified
+  for (size_t i = 0; i < N; ++i)
+    BOOST_CHECK(data[i] == static_cast<int>(i));
+  ::munmap(data, bytes);
+
+  return 0;
+}
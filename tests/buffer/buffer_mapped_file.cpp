@@ -0,0 +1,104 @@
+/* RUN: %{execute}%s
+
+   Check the buffers using a file mapped in memory as storage, with
+   the different mapping modes
+*/
+#include <CL/sycl.hpp>
+
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <vector>
+
+#include <boost/test/minimal.hpp>
+
+using namespace cl::sycl;
+
+constexpr size_t N = 3000;
+
+/// Read the integers of a file, after an offset in bytes
+std::vector<int> read_file(const std::string &path, std::size_t offset) {
+  std::vector<int> v(N);
+  std::ifstream f { path, std::ios::binary };
+  f.seekg(offset);
+  f.read(reinterpret_cast<char *>(v.data()), N*sizeof(int));
+  return v;
+}
+
+
+/// Add 1 to the elements of a buffer with a kernel
+template <typename Buffer>
+void increment(queue &q, Buffer &b) {
+  q.submit([&] (handler &cgh) {
+      auto a = b.template get_access<access::mode::read_write>(cgh);
+      cgh.parallel_for(b.get_range(), [=] (id<1> i) { a[i] += 1; });
+    });
+}
+
+
+int test_main(int argc, char *argv[]) {
+  queue q;
+  auto path = (std::filesystem::temp_directory_path()
+               / "trisycl_buffer_mapped_file.bin").string();
+  std::remove(path.c_str());
+
+  // Create the file through a shared mapping, after a header of 10 bytes
+  {
+    buffer<int> b { mapped_file { path, mapped_file::mode::read_write_shared,
+                                  10 },
+                    N };
+    q.submit([&] (handler &cgh) {
+        auto a = b.get_access<access::mode::discard_write>(cgh);
+        cgh.parallel_for(range<1> { N }, [=] (id<1> i) { a[i] = i[0]; });
+      });
+  }
+  BOOST_CHECK(std::filesystem::file_size(path) == 10 + N*sizeof(int));
+  auto content = read_file(path, 10);
+  for (size_t i = 0; i < N; ++i)
+    BOOST_CHECK(content[i] == static_cast<int>(i));
+
+  // The private and read-only mappings never modify the file
+  for (auto mode : { mapped_file::mode::read_write_private,
+                     mapped_file::mode::read_only }) {
+    buffer<int> b { mapped_file { path, mode, 10 }, N };
+    increment(q, b);
+    auto a = b.get_access<access::mode::read>();
+    for (size_t i = 0; i < N; ++i)
+      BOOST_CHECK(a[i] == static_cast<int>(i + 1));
+  }
+  BOOST_CHECK(read_file(path, 10) == content);
+
+  // A sub-buffer follows the copy on write of its read-only buffer
+  {
+    buffer<int> b { mapped_file { path, mapped_file::mode::read_only, 10 },
+                    N };
+    buffer<int> half { b, id<1> { N/2 }, range<1> { N/2 } };
+    increment(q, half);
+    auto a = b.get_access<access::mode::read>();
+    for (size_t i = 0; i < N; ++i)
+      BOOST_CHECK(a[i] == static_cast<int>(i + (i >= N/2)));
+  }
+
+  // Update the file in place
+  {
+    buffer<int> b { mapped_file { path, mapped_file::mode::read_write_shared,
+                                  10 },
+                    N };
+    increment(q, b);
+  }
+  content = read_file(path, 10);
+  for (size_t i = 0; i < N; ++i)
+    BOOST_CHECK(content[i] == static_cast<int>(i + 1));
+
+  // A read-only file has to be large enough
+  bool thrown = false;
+  try {
+    buffer<int> b { mapped_file { path }, 2*N };
+  } catch (const runtime_error &) {
+    thrown = true;
+  }
+  BOOST_CHECK(thrown);
+
+  std::remove(path.c_str());
+  return 0;
+}
@@ -0,0 +1,75 @@
+/* RUN: %{execute}%s
+
+   Check the buffers placed on the NUMA nodes with the different
+   policies of the numa_buffer_allocator, processed by pinned threads
+*/
+#include <CL/sycl.hpp>
+
+#ifdef __linux__
+#include <sched.h>
+#endif
+
+#include <boost/test/minimal.hpp>
+
+using namespace cl::sycl;
+
+constexpr size_t M = 300;
+constexpr size_t N = 1000;
+
+/// Run a kernel on a buffer placed with \param policy
+void check(queue &q, numa_policy policy) {
+  buffer<int, 2, numa_buffer_allocator<int>> b {
+    range<2> { M, N }, numa_buffer_allocator<int> { policy }
+  };
+  q.submit([&] (handler &cgh) {
+      auto w = b.get_access<access::mode::discard_write>(cgh);
+      cgh.parallel_for(range<2> { M, N }, [=] (id<2> i) {
+          w[i] = i[0]*N + i[1];
+        });
+    });
+  auto r = b.get_access<access::mode::read>();
+  for (size_t i = 0; i < M; ++i)
+    for (size_t j = 0; j < N; ++j)
+      BOOST_CHECK(r[i][j] == static_cast<int>(i*N + j));
+}
+
+
+int test_main(int argc, char *argv[]) {
+  queue q { property_list { property::queue::pin_threads {} } };
+  BOOST_CHECK(q.has_property<property::queue::pin_threads>());
+  BOOST_CHECK(detail::numa::instance()->is_pinning());
+
+#ifdef __linux__
+  cpu_set_t caller;
+  BOOST_CHECK(::sched_getaffinity(0, sizeof(caller), &caller) == 0);
+#endif
+
+  check(q, numa_policy::first_touch);
+  check(q, numa_policy::interleave);
+  check(q, numa_policy::bind);
+
+#ifdef __linux__
+  // Neither the calling thread nor the executor workers are pinned
+  cpu_set_t after;
+  BOOST_CHECK(::sched_getaffinity(0, sizeof(after), &after) == 0);
+  BOOST_CHECK(CPU_EQUAL(&caller, &after));
+  buffer<bool> worker_unchanged { 1 };
+  q.submit([&] (handler &cgh) {
+      auto u = worker_unchanged.get_access<access::mode::discard_write>(cgh);
+      cgh.single_task([=] {
+          cpu_set_t worker;
+          u[0] = ::sched_getaffinity(0, sizeof(worker), &worker) == 0
+            && CPU_EQUAL(&caller, &worker);
+        });
+    });
+  BOOST_CHECK(worker_unchanged.get_access<access::mode::read>()[0]);
+#endif
+
+  // The allocators are equal only with the same placement
+  BOOST_CHECK(numa_buffer_allocator<int> {}
+              == numa_buffer_allocator<float> {});
+  BOOST_CHECK((numa_buffer_allocator<int> { numa_policy::bind, 1 }
+               != numa_buffer_allocator<int> { numa_policy::bind, 0 }));
+
+  return 0;
+}
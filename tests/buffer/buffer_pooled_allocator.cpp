@@ -0,0 +1,93 @@
+/* RUN: %{execute}%s
+
+   Check that the buffers allocate their memory with the user allocator
+   and that the pooled_buffer_allocator recycles the memory of the
+   destroyed buffers
+*/
+#include <CL/sycl.hpp>
+
+#include <cstdint>
+#include <memory>
+
+#include <boost/test/minimal.hpp>
+
+using namespace cl::sycl;
+
+constexpr size_t N = 1000;
+
+/// An over-aligned type, such as a vector of a SIMD extension
+struct alignas(256) wide {
+  int v[4];
+};
+
+/// Count the allocated elements
+int allocated = 0;
+
+template <typename T>
+struct counting_allocator : std::allocator<T> {
+  template <typename U>
+  struct rebind { using other = counting_allocator<U>; };
+
+  counting_allocator() = default;
+
+  template <typename U>
+  counting_allocator(const counting_allocator<U> &) {}
+
+  T *allocate(std::size_t n) {
+    allocated += n;
+    return std::allocator<T>::allocate(n);
+  }
+
+  void deallocate(T *p, std::size_t n) {
+    allocated -= n;
+    std::allocator<T>::deallocate(p, n);
+  }
+};
+
+
+/// Run a kernel on a temporary buffer and return its memory address
+template <typename Allocator>
+int *step(queue &q, int value) {
+  buffer<int, 1, Allocator> tmp { N };
+  q.submit([&] (handler &cgh) {
+      auto t = tmp.template get_access<access::mode::discard_write>(cgh);
+      cgh.parallel_for(range<1> { N }, [=] (id<1> i) { t[i] = value; });
+    });
+  // So that the buffer is released by the kernel before returning
+  q.wait();
+  auto t = tmp.template get_access<access::mode::read>();
+  BOOST_CHECK(t[N - 1] == value);
+  return &t[0];
+}
+
+
+int test_main(int argc, char *argv[]) {
+  queue q;
+  {
+    buffer<int, 1, counting_allocator<int>> a { N };
+    BOOST_CHECK(allocated == N);
+    // The copy on write of const host data uses the allocator too
+    const int init[] = { 1, 2, 3 };
+    buffer<int, 1, counting_allocator<int>> c { init, 3 };
+    c.get_access<access::mode::write>()[0] = 0;
+    BOOST_CHECK(allocated == N + 3);
+  }
+  BOOST_CHECK(allocated == 0);
+
+  // The temporary buffers of all the steps use the same memory
+  auto first = step<pooled_buffer_allocator<int>>(q, 0);
+  for (int i = 1; i < 10; ++i)
+    BOOST_CHECK(step<pooled_buffer_allocator<int>>(q, i) == first);
+  pooled_buffer_allocator<int>::release();
+
+  // The over-aligned types keep their alignment, even when recycled
+  for (int i = 0; i < 3; ++i) {
+    buffer<wide, 1, pooled_buffer_allocator<wide>> w { 5 };
+    auto a = w.get_access<access::mode::discard_write>();
+    BOOST_CHECK(reinterpret_cast<std::uintptr_t>(&a[0]) % alignof(wide) == 0);
+    a[4].v[3] = i;
+  }
+  pooled_buffer_allocator<wide>::release();
+
+  return 0;
+}
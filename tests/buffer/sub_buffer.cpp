@@ -0,0 +1,93 @@
+/* RUN: %{execute}%s
+
+   Check that sub-buffers alias the memory of their buffer and that the
+   kernels writing disjoint sub-buffers run concurrently, while a
+   kernel using the whole buffer waits for them
+*/
+#include <CL/sycl.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+#include <boost/test/minimal.hpp>
+
+using namespace cl::sycl;
+using namespace std::chrono_literals;
+
+constexpr size_t M = 4;
+constexpr size_t N = 8;
+
+int test_main(int argc, char *argv[]) {
+  // Have enough workers to run the writers concurrently
+  queue q { property_list { property::queue::executor_concurrency { 4 } } };
+  buffer<int, 2> a { range<2> { M, N } };
+  // The 2 halves of the rows
+  buffer<int, 2> halves[2] = {
+    buffer<int, 2> { a, id<2> { 0, 0 }, range<2> { M/2, N } },
+    buffer<int, 2> { a, id<2> { M/2, 0 }, range<2> { M/2, N } }
+  };
+  BOOST_CHECK(halves[1].is_sub_buffer() && !a.is_sub_buffer());
+  BOOST_CHECK(halves[1].get_range() == (range<2> { M/2, N }));
+
+  // 2 writers which can only complete if they run at the same time
+  std::atomic<int> running_writers { 0 };
+  std::atomic<bool> concurrent_writers[2] = { false, false };
+  for (int h = 0; h < 2; ++h)
+    q.submit([&, h](handler &cgh) {
+        auto w = halves[h].get_access<access::mode::discard_write>(cgh);
+        cgh.single_task([=, &running_writers, &concurrent_writers] {
+            ++running_writers;
+            for (auto deadline = std::chrono::steady_clock::now() + 10s;
+                 running_writers < 2
+                   && std::chrono::steady_clock::now() < deadline;)
+              std::this_thread::yield();
+            concurrent_writers[h] = running_writers >= 2;
+            // Let the next reader read too early if it does not wait
+            std::this_thread::sleep_for(50ms);
+            for (size_t i = 0; i < M/2; ++i)
+              for (size_t j = 0; j < N; ++j)
+                w[i][j] = h + 1;
+          });
+      });
+
+  // This kernel on the whole buffer has to wait for both the writers
+  q.submit([&](handler &cgh) {
+      auto w = a.get_access<access::mode::read_write>(cgh);
+      cgh.parallel_for(range<2> { M, N }, [=] (id<2> i) {
+          w[i] = 10*w[i] + i[0];
+        });
+    });
+
+  // A sub-buffer of a sub-buffer still aliases the root buffer
+  buffer<int, 2> row { halves[1], id<2> { 1, 0 }, range<2> { 1, N } };
+  q.submit([&](handler &cgh) {
+      auto w = row.get_access<access::mode::read_write>(cgh);
+      cgh.parallel_for(range<2> { 1, N }, [=] (id<2> i) { w[i] += i[1]; });
+    });
+  q.wait();
+  BOOST_CHECK(concurrent_writers[0] && concurrent_writers[1]);
+
+  {
+    auto aa = a.get_access<access::mode::read>();
+    for (size_t i = 0; i < M; ++i)
+      for (size_t j = 0; j < N; ++j)
+        BOOST_CHECK(aa[i][j] == static_cast<int>(10*(1 + i/(M/2)) + i
+                                                 + (i == M - 1 ? j : 0)));
+  }
+
+  // Only the contiguous regions inside the buffer are allowed
+  auto throws = [&] (id<2> base, range<2> r) {
+    try {
+      buffer<int, 2> s { a, base, r };
+    } catch (const exception &) {
+      return true;
+    }
+    return false;
+  };
+  BOOST_CHECK(throws({ 0, 0 }, { 2, N/2 }));
+  BOOST_CHECK(throws({ M/2, 0 }, { M, N }));
+  BOOST_CHECK(!throws({ 1, 2 }, { 1, N/2 }));
+
+  return 0;
+}
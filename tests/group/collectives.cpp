@@ -0,0 +1,113 @@
+/* RUN: %{execute}%s
+
+   Check the work-group collective algorithms in nd_range kernels, and
+   their errors in the hierarchical kernels
+*/
+#include <CL/sycl.hpp>
+
+#include <exception>
+#include <functional>
+
+#include <boost/test/minimal.hpp>
+
+using namespace cl::sycl;
+
+template <int Dimensions>
+void check_collectives(nd_range<Dimensions> ndr) {
+  const auto r = ndr.get_global_range();
+  const auto local_size = ndr.get_local_range().size();
+  queue q;
+  // Per work-item results, indexed by global linear id
+  buffer<int> broadcast { r.size() };
+  buffer<int> sum { r.size() };
+  buffer<int> max { r.size() };
+  buffer<int> inclusive { r.size() };
+  buffer<int> exclusive { r.size() };
+  buffer<int> local { r.size() };
+  q.submit([&](handler &cgh) {
+      auto b = broadcast.get_access<access::mode::discard_write>(cgh);
+      auto s = sum.get_access<access::mode::discard_write>(cgh);
+      auto m = max.get_access<access::mode::discard_write>(cgh);
+      auto in = inclusive.get_access<access::mode::discard_write>(cgh);
+      auto ex = exclusive.get_access<access::mode::discard_write>(cgh);
+      auto l = local.get_access<access::mode::discard_write>(cgh);
+      cgh.parallel_for(ndr, [=] (nd_item<Dimensions> i) {
+          const auto g = i.get_global_linear_id();
+          const int x = i.get_local_linear_id();
+          l[g] = x;
+          // Each work-group broadcasts the value of its last work-item
+          b[g] = group_broadcast(i, 1000 + x, local_size - 1);
+          s[g] = reduce_over_group(i, x, std::plus<> {});
+          m[g] = reduce_over_group(i, x, 7, maximum<> {});
+          i.barrier();
+          in[g] = inclusive_scan_over_group(i, x, std::plus<> {});
+          ex[g] = exclusive_scan_over_group(i, x, std::plus<> {});
+        });
+    });
+  auto b = broadcast.get_access<access::mode::read>();
+  auto s = sum.get_access<access::mode::read>();
+  auto m = max.get_access<access::mode::read>();
+  auto in = inclusive.get_access<access::mode::read>();
+  auto ex = exclusive.get_access<access::mode::read>();
+  auto l = local.get_access<access::mode::read>();
+  const int n = local_size;
+  for (std::size_t i = 0; i < r.size(); ++i) {
+    BOOST_CHECK(b[i] == 1000 + n - 1);
+    BOOST_CHECK(s[i] == n*(n - 1)/2);
+    BOOST_CHECK(m[i] == std::max(7, n - 1));
+    BOOST_CHECK(in[i] == l[i]*(l[i] + 1)/2);
+    BOOST_CHECK(ex[i] == l[i]*(l[i] - 1)/2);
+  }
+}
+
+int test_main(int argc, char *argv[]) {
+  check_collectives(nd_range<1> { range<1> { 1 }, range<1> { 1 } });
+  check_collectives(nd_range<1> { range<1> { 256 }, range<1> { 32 } });
+  check_collectives(nd_range<2> { range<2> { 8, 12 }, range<2> { 4, 3 } });
+  check_collectives(nd_range<3> { range<3> { 4, 4, 4 },
+                                  range<3> { 2, 2, 4 } });
+
+  /* Without an engine running the work-items concurrently, the
+     collectives of the hierarchical kernels cannot work and report it
+     to the async_handler of the queue */
+  int not_supported = 0;
+  queue q { async_handler { [&] (exception_list l) {
+        for (auto &e : l)
+          try {
+            std::rethrow_exception(e);
+          } catch (const feature_not_supported &) {
+            ++not_supported;
+          }
+      } } };
+  buffer<int> result { 1 };
+  q.submit([&](handler &cgh) {
+      auto r = result.get_access<access::mode::discard_write>(cgh);
+      cgh.parallel_for_work_group(range<1> { 4 }, range<1> { 8 },
+                                  [=] (group<1> g) {
+          r[0] = reduce_over_group(g, 1, std::plus<> {});
+        });
+    });
+  q.submit([&](handler &cgh) {
+      cgh.parallel_for_work_group(range<1> { 4 }, range<1> { 8 },
+                                  [=] (group<1> g) {
+          g.parallel_for_work_item([&] (h_item<1> i) { i.barrier(); });
+        });
+    });
+  q.wait_and_throw();
+  BOOST_CHECK(not_supported == 2);
+  // The errors are reported only once
+  q.wait_and_throw();
+  BOOST_CHECK(not_supported == 2);
+  // A work-group of 1 work-item works without an engine
+  q.submit([&](handler &cgh) {
+      auto r = result.get_access<access::mode::discard_write>(cgh);
+      cgh.parallel_for_work_group(range<1> { 4 }, range<1> { 1 },
+                                  [=] (group<1> g) {
+          r[0] = reduce_over_group(g, 42, std::plus<> {});
+        });
+    });
+  q.wait_and_throw();
+  BOOST_CHECK(not_supported == 2);
+  BOOST_CHECK(result.get_access<access::mode::read>()[0] == 42);
+  return 0;
+}
@@ -0,0 +1,154 @@
+/* RUN: %{execute}%s
+
+   Check the sub-group decomposition and the sub-group collectives in
+   nd_range kernels, including when only some sub-groups call them
+*/
+#include <CL/sycl.hpp>
+
+#include <algorithm>
+#include <exception>
+#include <functional>
+
+#include <boost/test/minimal.hpp>
+
+using namespace cl::sycl;
+
+constexpr int max_size = sub_group::max_size;
+
+void check_sub_groups(std::size_t global_size, std::size_t local_size) {
+  queue q;
+  buffer<int> lane { global_size };
+  buffer<int> size { global_size };
+  buffer<int> sum { global_size };
+  buffer<int> scan { global_size };
+  buffer<int> left { global_size };
+  buffer<int> right { global_size };
+  buffer<int> xored { global_size };
+  buffer<int> first { global_size };
+  q.submit([&](handler &cgh) {
+      auto l = lane.get_access<access::mode::discard_write>(cgh);
+      auto n = size.get_access<access::mode::discard_write>(cgh);
+      auto s = sum.get_access<access::mode::discard_write>(cgh);
+      auto sc = scan.get_access<access::mode::discard_write>(cgh);
+      auto le = left.get_access<access::mode::discard_write>(cgh);
+      auto r = right.get_access<access::mode::discard_write>(cgh);
+      auto x = xored.get_access<access::mode::discard_write>(cgh);
+      auto f = first.get_access<access::mode::discard_write>(cgh);
+      cgh.parallel_for(nd_range<1> { global_size, local_size },
+                       [=] (nd_item<1> i) {
+          const auto g = i.get_global_linear_id();
+          auto sg = i.get_sub_group();
+          const int id = sg.get_local_linear_id();
+          l[g] = id;
+          n[g] = sg.get_local_linear_range();
+          s[g] = reduce_over_group(sg, id, std::plus<> {});
+          sc[g] = inclusive_scan_over_group(sg, 1, std::plus<> {});
+          le[g] = shift_group_left(sg, id);
+          r[g] = shift_group_right(sg, id, 2);
+          x[g] = permute_group_by_xor(sg, id, 1);
+          f[g] = group_broadcast(sg, int(i.get_local_linear_id()));
+        });
+    });
+  auto l = lane.get_access<access::mode::read>();
+  auto n = size.get_access<access::mode::read>();
+  auto s = sum.get_access<access::mode::read>();
+  auto sc = scan.get_access<access::mode::read>();
+  auto le = left.get_access<access::mode::read>();
+  auto r = right.get_access<access::mode::read>();
+  auto x = xored.get_access<access::mode::read>();
+  auto f = first.get_access<access::mode::read>();
+  for (std::size_t g = 0; g < global_size; ++g) {
+    const int local = g % local_size;
+    const int id = local % max_size;
+    const int sg_size = std::min<int>(max_size, local_size - local + id);
+    BOOST_CHECK(l[g] == id);
+    BOOST_CHECK(n[g] == sg_size);
+    BOOST_CHECK(s[g] == sg_size*(sg_size - 1)/2);
+    BOOST_CHECK(sc[g] == id + 1);
+    BOOST_CHECK(le[g] == (id + 1 < sg_size ? id + 1 : id));
+    BOOST_CHECK(r[g] == (id >= 2 ? id - 2 : id));
+    BOOST_CHECK(x[g] == ((id ^ 1) < sg_size ? id ^ 1 : id));
+    BOOST_CHECK(f[g] == local - id);
+  }
+}
+
+/* Only the sub-groups 1 and 2 call a collective, each a different one,
+   which synchronizes only the work-items of their sub-group */
+void check_sub_group_branch(std::size_t local_size) {
+  queue q;
+  buffer<int> result { local_size };
+  buffer<int> next { local_size };
+  q.submit([&](handler &cgh) {
+      auto r = result.get_access<access::mode::read_write>(cgh);
+      auto n = next.get_access<access::mode::discard_write>(cgh);
+      cgh.parallel_for(nd_range<1> { local_size, local_size },
+                       [=] (nd_item<1> i) {
+          auto sg = i.get_sub_group();
+          const auto l = i.get_local_linear_id();
+          int v = -1;
+          if (sg.get_group_linear_id() == 1)
+            v = reduce_over_group(sg, 1, std::plus<> {});
+          else if (sg.get_group_linear_id() == 2)
+            v = inclusive_scan_over_group(sg, 1, std::plus<> {});
+          r[l] = v;
+          // The sub-groups still in their collective are waited for
+          i.barrier();
+          n[l] = r[(l + max_size) % local_size];
+        });
+    });
+  auto expected = [&] (std::size_t l) {
+    const auto s = l / max_size;
+    if (s == 1)
+      return std::min<int>(max_size, local_size - max_size);
+    if (s == 2)
+      return int(l % max_size) + 1;
+    return -1;
+  };
+  auto r = result.get_access<access::mode::read>();
+  auto n = next.get_access<access::mode::read>();
+  for (std::size_t l = 0; l < local_size; ++l) {
+    BOOST_CHECK(r[l] == expected(l));
+    BOOST_CHECK(n[l] == expected((l + max_size) % local_size));
+  }
+}
+
+
+#ifdef TRISYCL_FIBER_BARRIER
+/* A collective not called by all the work-items of a sub-group cannot
+   end, which is reported instead of waiting forever */
+void check_sub_group_mismatch() {
+  int errors = 0;
+  queue q { async_handler { [&] (exception_list l) {
+        for (auto &e : l)
+          try {
+            std::rethrow_exception(e);
+          } catch (const kernel_error &) {
+            ++errors;
+          }
+      } } };
+  q.submit([&](handler &cgh) {
+      cgh.parallel_for(nd_range<1> { 2*max_size, 2*max_size },
+                       [=] (nd_item<1> i) {
+          auto sg = i.get_sub_group();
+          if (!sg.leader())
+            reduce_over_group(sg, 1, std::plus<> {});
+        });
+    });
+  q.wait_and_throw();
+  BOOST_CHECK(errors == 1);
+}
+#endif
+
+int test_main(int argc, char *argv[]) {
+  check_sub_groups(1, 1);
+  check_sub_groups(256, 64);
+  // A partial last sub-group in each work-group
+  check_sub_groups(3*(max_size + 3), max_size + 3);
+  check_sub_group_branch(4*max_size + 3);
+  // With a partial sub-group 1
+  check_sub_group_branch(2*max_size - 1);
+#ifdef TRISYCL_FIBER_BARRIER
+  check_sub_group_mismatch();
+#endif
+  return 0;
+}
@@ -0,0 +1,43 @@
+/* RUN: %{execute}%s
+
+   Check nd_item::barrier() with a tree reduction in local memory in
+   each work-group, the work-groups being executed concurrently
+*/
+#include <CL/sycl.hpp>
+
+#include <boost/test/minimal.hpp>
+
+using namespace cl::sycl;
+
+constexpr std::size_t groups = 64;
+constexpr std::size_t local_size = 256;
+
+int test_main(int argc, char *argv[]) {
+  buffer<unsigned int> sums { groups };
+  queue q;
+  q.submit([&](handler &cgh) {
+      auto s = sums.get_access<access::mode::discard_write>(cgh);
+      accessor<unsigned int, 1, access::mode::read_write,
+               access::target::local> partial { local_size, cgh };
+      cgh.parallel_for<class reduce>(
+        nd_range<1> { groups*local_size, local_size },
+        [=] (nd_item<1> i) {
+          auto l = i.get_local_id(0);
+          partial[l] = i.get_global_id(0);
+          for (auto stride = local_size/2; stride > 0; stride /= 2) {
+            i.barrier(access::fence_space::local_space);
+            if (l < stride)
+              partial[l] += partial[l + stride];
+          }
+          if (l == 0)
+            s[i.get_group(0)] = partial[0];
+        });
+    });
+  auto s = sums.get_access<access::mode::read>();
+  for (std::size_t g = 0; g < groups; ++g) {
+    // The sum of the global ids of the work-items of the group
+    auto first = g*local_size;
+    BOOST_CHECK(s[g] == local_size*first + local_size*(local_size - 1)/2);
+  }
+  return 0;
+}
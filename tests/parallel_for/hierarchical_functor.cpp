@@ -0,0 +1,56 @@
+/* RUN: %{execute}%s
+
+   Check the kernel types accepted by parallel_for_work_item: lambda,
+   generic lambda, function object and std::function
+*/
+#include <CL/sycl.hpp>
+
+#include <functional>
+
+#include <boost/test/minimal.hpp>
+
+using namespace cl::sycl;
+
+constexpr std::size_t groups = 4;
+constexpr std::size_t local_size = 8;
+
+/// A function object writing the global linear id of a work-item
+template <typename Accessor>
+struct write_id {
+  Accessor a;
+  std::size_t offset;
+
+  void operator()(h_item<1> i) const {
+    a[i.get_global_id(0) + offset] = i.get_global_linear_id() + offset;
+  }
+};
+
+int test_main(int argc, char *argv[]) {
+  buffer<unsigned int> b { groups*local_size*4 };
+  queue q;
+  q.submit([&](handler &cgh) {
+      auto a = b.get_access<access::mode::discard_write>(cgh);
+      cgh.parallel_for_work_group<class functors>(
+        nd_range<1> { groups*local_size, local_size },
+        [=] (group<1> g) {
+          g.parallel_for_work_item([&] (h_item<1> i) {
+              a[i.get_global_id(0)] = i.get_global_linear_id();
+            });
+          g.parallel_for_work_item([&] (auto i) {
+              a[i.get_global_id(0) + groups*local_size] =
+                i.get_global_linear_id() + groups*local_size;
+            });
+          g.parallel_for_work_item(write_id<decltype(a)> {
+              a, 2*groups*local_size });
+          std::function<void(h_item<1>)> f = [&] (h_item<1> i) {
+            a[i.get_global_id(0) + 3*groups*local_size] =
+              i.get_global_linear_id() + 3*groups*local_size;
+          };
+          g.parallel_for_work_item(f);
+        });
+    });
+  auto a = b.get_access<access::mode::read>();
+  for (std::size_t i = 0; i < a.get_count(); ++i)
+    BOOST_CHECK(a[i] == i);
+  return 0;
+}
@@ -0,0 +1,40 @@
+/* RUN: %{execute}%s
+
+   Check hierarchical kernels with many work-groups, each one using its
+   own local memory between 2 parallel_for_work_item
+*/
+#include <CL/sycl.hpp>
+
+#include <boost/test/minimal.hpp>
+
+using namespace cl::sycl;
+
+constexpr std::size_t groups = 100;
+constexpr std::size_t local_size = 32;
+
+int test_main(int argc, char *argv[]) {
+  buffer<std::size_t> rotated { groups*local_size };
+  queue q;
+  q.submit([&](handler &cgh) {
+      auto r = rotated.get_access<access::mode::discard_write>(cgh);
+      accessor<std::size_t, 1, access::mode::read_write,
+               access::target::local> cache { local_size, cgh };
+      cgh.parallel_for_work_group<class rotate>(
+        nd_range<1> { groups*local_size, local_size },
+        [=] (group<1> g) {
+          g.parallel_for_work_item([&] (h_item<1> i) {
+              cache[i.get_local_id(0)] = i.get_global_id(0);
+            });
+          // There is an implicit barrier here
+          g.parallel_for_work_item([&] (h_item<1> i) {
+              auto l = i.get_local_id(0);
+              r[i.get_global_id()] = cache[(l + 1)%local_size];
+            });
+        });
+    });
+  auto r = rotated.get_access<access::mode::read>();
+  for (std::size_t g = 0; g < groups; ++g)
+    for (std::size_t l = 0; l < local_size; ++l)
+      BOOST_CHECK(r[g*local_size + l] == g*local_size + (l + 1)%local_size);
+  return 0;
+}
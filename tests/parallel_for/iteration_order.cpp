@@ -0,0 +1,98 @@
+/* RUN: %{execute}%s
+
+   Check that the tiled and Morton iteration orders and the
+   partitioners of a parallel_for on a range execute each work-item
+   exactly once
+*/
+#include <CL/sycl.hpp>
+
+#include <vector>
+
+#include <boost/test/minimal.hpp>
+
+using namespace cl::sycl;
+
+/// Count the executions of each work-item with an id or an item kernel
+template <int Dimensions, typename Submit>
+void check_visits(range<Dimensions> r, queue &q, Submit submit) {
+  buffer<unsigned int, Dimensions> visits { r };
+  q.submit([&](handler &cgh) {
+      auto v = visits.template get_access<access::mode::discard_write>(cgh);
+      cgh.parallel_for(r, [=] (id<Dimensions> i) { v[i] = 0; });
+    });
+  q.submit([&](handler &cgh) {
+      auto v = visits.template get_access<access::mode::read_write>(cgh);
+      submit(cgh, [=] (id<Dimensions> i) { ++v[i]; });
+    });
+  q.submit([&](handler &cgh) {
+      auto v = visits.template get_access<access::mode::read_write>(cgh);
+      submit(cgh, [=] (item<Dimensions> i) { ++v[i.get_id()]; });
+    });
+  auto v = visits.template get_access<access::mode::read>();
+  std::vector<unsigned int> flat(v.get_pointer(), v.get_pointer() + r.size());
+  for (auto n : flat)
+    BOOST_CHECK(n == 2);
+}
+
+
+template <int Dimensions>
+void check_orders(range<Dimensions> r) {
+  queue q;
+  // Iteration order given to the kernel
+  check_visits(r, q, [&] (handler &cgh, auto kernel) {
+      cgh.parallel_for(r, property::kernel::tiled_iteration { 4, 3 },
+                       kernel);
+    });
+  check_visits(r, q, [&] (handler &cgh, auto kernel) {
+      cgh.parallel_for(r, property::kernel::morton_iteration { 2 }, kernel);
+    });
+  // Iteration order given to the queue
+  queue tiled { property_list { property::kernel::tiled_iteration { 5 } } };
+  check_visits(r, tiled, [&] (handler &cgh, auto kernel) {
+      cgh.parallel_for(r, kernel);
+    });
+  queue morton { property_list { property::kernel::morton_iteration {} } };
+  check_visits(r, morton, [&] (handler &cgh, auto kernel) {
+      cgh.parallel_for(r, kernel);
+    });
+  // Partitioners given to the kernel, the affinity one being replayed
+  using kind = property::kernel::partitioner::kind;
+  for (auto k : { kind::automatic, kind::static_split,
+                  kind::affinity, kind::affinity })
+    check_visits(r, q, [&] (handler &cgh, auto kernel) {
+        cgh.parallel_for(r, property::kernel::partitioner { k, 64 },
+                         kernel);
+      });
+  // A partitioner given to the queue combined with a kernel order
+  queue affinity {
+    property_list { property::kernel::partitioner { kind::affinity, 16 } }
+  };
+  check_visits(r, affinity, [&] (handler &cgh, auto kernel) {
+      cgh.parallel_for(r, property::kernel::morton_iteration { 4 }, kernel);
+    });
+}
+
+
+int test_main(int argc, char *argv[]) {
+  // The tiles of a 4x4 grid of 1x1 tiles in Morton order
+  cl::sycl::detail::tile_schedule<2> morton {
+    range<2> { 4, 4 },
+    property::kernel::morton_iteration { 1 }.get_policy()
+  };
+  const std::size_t z_order[][2] = {
+    { 0, 0 }, { 0, 1 }, { 1, 0 }, { 1, 1 },
+    { 0, 2 }, { 0, 3 }, { 1, 2 }, { 1, 3 },
+    { 2, 0 }, { 2, 1 }, { 3, 0 }, { 3, 1 },
+    { 2, 2 }, { 2, 3 }, { 3, 2 }, { 3, 3 }
+  };
+  BOOST_CHECK(morton.size() == 16);
+  for (std::size_t t = 0; t < morton.size(); ++t)
+    BOOST_CHECK(morton.tile_id(t) == (id<2> { z_order[t][0], z_order[t][1] }));
+
+  check_orders(range<1> { 1 });
+  check_orders(range<1> { 1000 });
+  check_orders(range<2> { 1, 1 });
+  check_orders(range<2> { 37, 91 });
+  check_orders(range<3> { 7, 13, 17 });
+  return 0;
+}
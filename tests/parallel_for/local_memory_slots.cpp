@@ -0,0 +1,43 @@
+/* RUN: %{execute}%s
+
+   Check that each concurrent work-group gets its own local memory even
+   when the thread budget exceeds the number of local memory slots
+*/
+#include <CL/sycl.hpp>
+
+#include <boost/test/minimal.hpp>
+
+using namespace cl::sycl;
+
+constexpr std::size_t groups = 1000;
+constexpr std::size_t local_size = 4;
+
+int test_main(int argc, char *argv[]) {
+  queue q { property_list {
+      property::queue::thread_budget {
+        2*detail::max_local_memory_slots } } };
+  buffer<std::size_t> ids { groups };
+  q.submit([&](handler &cgh) {
+      auto w = ids.get_access<access::mode::discard_write>(cgh);
+      accessor<std::size_t, 1, access::mode::read_write,
+               access::target::local> l { local_size, cgh };
+      cgh.parallel_for<class slots>(
+        nd_range<1> { groups*local_size, local_size },
+        [=] (nd_item<1> i) {
+          l[i.get_local_id(0)] = i.get_group(0);
+          i.barrier(access::fence_space::local_space);
+          // The last work-item checks the whole local memory
+          if (i.get_local_id(0) == local_size - 1) {
+            std::size_t g = i.get_group(0);
+            for (std::size_t j = 0; j < local_size; ++j)
+              if (l[j] != i.get_group(0))
+                g = groups;
+            w[i.get_group(0)] = g;
+          }
+        });
+    });
+  auto r = ids.get_access<access::mode::read>();
+  for (std::size_t g = 0; g < groups; ++g)
+    BOOST_CHECK(r[g] == g);
+  return 0;
+}
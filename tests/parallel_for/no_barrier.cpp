@@ -0,0 +1,83 @@
+/* RUN: %{execute}%s
+
+   Check the barrier-free execution of nd_range kernels, with each
+   work-item executed exactly once with consistent global, local and
+   group ids, and that a barrier is reported as not supported
+*/
+#include <CL/sycl.hpp>
+
+#include <exception>
+
+#include <boost/test/minimal.hpp>
+
+using namespace cl::sycl;
+
+template <int Dimensions>
+void check_nd_range(nd_range<Dimensions> ndr) {
+  auto r = ndr.get_global_range();
+  queue q;
+  buffer<unsigned int> visits { r.size() };
+  buffer<unsigned int> mismatches { 1 };
+  q.submit([&](handler &cgh) {
+      auto v = visits.get_access<access::mode::discard_write>(cgh);
+      cgh.parallel_for(range<1> { r.size() }, [=] (id<1> i) { v[i] = 0; });
+    });
+  {
+    auto m = mismatches.get_access<access::mode::discard_write>();
+    m[0] = 0;
+  }
+  q.submit([&](handler &cgh) {
+      auto v = visits.get_access<access::mode::read_write>(cgh);
+      auto m = mismatches.get_access<access::mode::atomic>(cgh);
+      cgh.parallel_for(ndr, property::kernel::no_barrier {},
+                       [=] (nd_item<Dimensions> i) {
+          std::size_t l = 0;
+          for (int d = 0; d < Dimensions; ++d) {
+            if (i.get_global_id(d) != i.get_group(d)*i.get_local_range()[d]
+                                      + i.get_local_id(d))
+              m[0]++;
+            l = l*r[d] + i.get_global_id(d);
+          }
+          ++v[l];
+        });
+    });
+  auto v = visits.get_access<access::mode::read>();
+  for (std::size_t i = 0; i < r.size(); ++i)
+    BOOST_CHECK(v[i] == 1);
+  auto m = mismatches.get_access<access::mode::read>();
+  BOOST_CHECK(m[0] == 0);
+}
+
+#ifdef TRISYCL_FIBER_BARRIER
+/* A barrier cannot work in a no_barrier kernel, where the work-items
+   are not fibers, which is reported to the async_handler */
+void check_barrier_not_supported() {
+  int not_supported = 0;
+  queue q { async_handler { [&] (exception_list l) {
+        for (auto &e : l)
+          try {
+            std::rethrow_exception(e);
+          } catch (const feature_not_supported &) {
+            ++not_supported;
+          }
+      } } };
+  q.submit([&](handler &cgh) {
+      cgh.parallel_for(nd_range<1> { range<1> { 64 }, range<1> { 8 } },
+                       property::kernel::no_barrier {},
+                       [=] (nd_item<1> i) { i.barrier(); });
+    });
+  q.wait_and_throw();
+  BOOST_CHECK(not_supported == 1);
+}
+#endif
+
+int test_main(int argc, char *argv[]) {
+  check_nd_range(nd_range<1> { range<1> { 1 }, range<1> { 1 } });
+  check_nd_range(nd_range<1> { range<1> { 1024 }, range<1> { 64 } });
+  check_nd_range(nd_range<2> { range<2> { 4, 1000 }, range<2> { 2, 8 } });
+  check_nd_range(nd_range<3> { range<3> { 6, 4, 8 }, range<3> { 3, 2, 4 } });
+#ifdef TRISYCL_FIBER_BARRIER
+  check_barrier_not_supported();
+#endif
+  return 0;
+}
@@ -0,0 +1,105 @@
+/* RUN: %{execute}%s
+
+   Check the reductions of parallel_for kernels on range and nd_range,
+   with the built-in combiners and a user combiner
+*/
+#include <CL/sycl.hpp>
+
+#include <cstdint>
+#include <cstdlib>
+#include <functional>
+
+#include <boost/test/minimal.hpp>
+
+using namespace cl::sycl;
+
+constexpr std::size_t size = 10000;
+
+// A user combiner keeping the value with the largest absolute value
+struct max_abs {
+  int operator()(int x, int y) const {
+    return std::abs(x) >= std::abs(y) ? x : y;
+  }
+};
+
+int test_main(int argc, char *argv[]) {
+  queue q;
+  buffer<int> sum { 1 };
+  buffer<int> min { 1 };
+  buffer<int> max { 1 };
+  buffer<std::uint32_t> bits { 1 };
+  buffer<int> user { 1 };
+  {
+    sum.get_access<access::mode::discard_write>()[0] = 42;
+    min.get_access<access::mode::discard_write>()[0] = 0;
+    max.get_access<access::mode::discard_write>()[0] = 0;
+    bits.get_access<access::mode::discard_write>()[0] = 0;
+    user.get_access<access::mode::discard_write>()[0] = 0;
+  }
+
+  // A sum with an id<> kernel, combined with the initial value
+  q.submit([&](handler &cgh) {
+      auto s = sum.get_access<access::mode::read_write>(cgh);
+      cgh.parallel_for(range<1> { size },
+                       reduction(s, std::plus<int> {}),
+                       [=] (id<1> i, auto &r) { r += i[0]; });
+    });
+  BOOST_CHECK(sum.get_access<access::mode::read>()[0]
+              == 42 + size*(size - 1)/2);
+
+  // A minimum and a maximum on a 2D item<> kernel
+  q.submit([&](handler &cgh) {
+      auto m = min.get_access<access::mode::read_write>(cgh);
+      cgh.parallel_for(range<2> { 100, 100 },
+                       reduction(m, minimum<int> {}),
+                       [=] (item<2> i, auto &r) {
+                         r.combine(int(i.get_linear_id()) - 5000);
+                       });
+    });
+  BOOST_CHECK(min.get_access<access::mode::read>()[0] == -5000);
+  q.submit([&](handler &cgh) {
+      auto m = max.get_access<access::mode::read_write>(cgh);
+      cgh.parallel_for(range<3> { 10, 20, 30 },
+                       reduction(m, maximum<> {}),
+                       [=] (id<3> i, auto &r) {
+                         r.combine(i[0]*1000 + i[1]*10 + i[2]);
+                       });
+    });
+  BOOST_CHECK(max.get_access<access::mode::read>()[0] == 9000 + 190 + 29);
+
+  // A bitwise or on a nd_range kernel with a barrier
+  q.submit([&](handler &cgh) {
+      auto b = bits.get_access<access::mode::read_write>(cgh);
+      cgh.parallel_for(nd_range<1> { range<1> { 32*8 }, range<1> { 8 } },
+                       reduction(b, std::bit_or<> {}),
+                       [=] (nd_item<1> i, auto &r) {
+                         i.barrier();
+                         r |= std::uint32_t { 1 } << i.get_group(0);
+                       });
+    });
+  BOOST_CHECK(bits.get_access<access::mode::read>()[0] == 0xffffffff);
+
+  // A user combiner with its identity on a 2D nd_range kernel
+  q.submit([&](handler &cgh) {
+      auto u = user.get_access<access::mode::read_write>(cgh);
+      cgh.parallel_for(nd_range<2> { range<2> { 40, 30 }, range<2> { 4, 3 } },
+                       reduction(u, 0, max_abs {}),
+                       [=] (nd_item<2> i, auto &r) {
+                         int v = i.get_global_linear_id();
+                         r.combine(v % 2 ? -v : v);
+                       });
+    });
+  BOOST_CHECK(user.get_access<access::mode::read>()[0] == -1199);
+
+  // A product into a host variable through a pointer
+  double product = 1;
+  q.submit([&](handler &cgh) {
+      cgh.parallel_for(range<1> { 20 },
+                       reduction(&product, std::multiplies<double> {}),
+                       [=] (id<1> i, auto &r) { r *= 2; });
+    });
+  q.wait();
+  BOOST_CHECK(product == 1 << 20);
+
+  return 0;
+}
@@ -0,0 +1,44 @@
+/* RUN: %{execute}%s
+
+   Check that multi-dimensional ranges with a small leading dimension
+   are fully iterated, each work-item exactly once
+*/
+#include <CL/sycl.hpp>
+
+#include <boost/test/minimal.hpp>
+
+using namespace cl::sycl;
+
+template <int Dimensions>
+void count_visits(range<Dimensions> r) {
+  queue q;
+  buffer<unsigned int> visits { r.size() };
+  q.submit([&](handler &cgh) {
+      auto v = visits.get_access<access::mode::discard_write>(cgh);
+      cgh.parallel_for(range<1> { r.size() }, [=] (id<1> i) { v[i] = 0; });
+    });
+  q.submit([&](handler &cgh) {
+      auto v = visits.get_access<access::mode::read_write>(cgh);
+      cgh.parallel_for(r, [=] (item<Dimensions> i) {
+          // Use a row-major linearization, the last dimension varying fastest
+          std::size_t l = 0;
+          for (int d = 0; d < Dimensions; ++d)
+            l = l*r[d] + i[d];
+          ++v[l];
+        });
+    });
+  auto v = visits.get_access<access::mode::read>();
+  for (std::size_t i = 0; i < r.size(); ++i)
+    BOOST_CHECK(v[i] == 1);
+}
+
+int test_main(int argc, char *argv[]) {
+  count_visits(range<1> { 1 });
+  count_visits(range<1> { 1001 });
+  count_visits(range<2> { 1, 7 });
+  count_visits(range<2> { 4, 1000 });
+  count_visits(range<2> { 1000, 3 });
+  count_visits(range<3> { 3, 17, 29 });
+  count_visits(range<3> { 2, 1, 5 });
+  return 0;
+}
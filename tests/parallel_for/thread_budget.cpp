@@ -0,0 +1,99 @@
+/* RUN: %{execute}%s
+
+   Test that the kernels running concurrently share the thread budget
+   without exceeding it, and that the host tasks do not use it
+*/
+#include <CL/sycl.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+#include <boost/test/minimal.hpp>
+
+using namespace cl::sycl;
+using namespace std::chrono_literals;
+
+constexpr size_t N = 1000;
+
+int test_main(int argc, char *argv[]) {
+  using budget = ::trisycl::detail::thread_budget;
+  queue q { property_list { property::queue::thread_budget { 4 },
+                            property::queue::executor_concurrency { 2 } } };
+  BOOST_CHECK(budget::instance()->get_budget() == 4);
+
+  // 2 kernels running at the same time
+  std::atomic<int> running { 0 };
+  std::size_t teams[2];
+  std::size_t in_use[2];
+  for (int k = 0; k < 2; ++k)
+    q.submit([&, k] (handler &cgh) {
+        cgh.single_task([&, k] {
+            ++running;
+            for (auto deadline = std::chrono::steady_clock::now() + 10s;
+                 running < 2 && std::chrono::steady_clock::now() < deadline;)
+              std::this_thread::yield();
+            teams[k] = budget::team_size();
+            in_use[k] = budget::instance()->get_threads_in_use();
+          });
+      });
+  q.wait();
+  BOOST_CHECK(running == 2);
+  // The shares of the kernels running together fit in the budget
+  for (int k = 0; k < 2; ++k) {
+    BOOST_CHECK(teams[k] >= 1);
+    BOOST_CHECK(in_use[k] <= 4);
+  }
+  // A kernel beyond the budget only runs on its own thread
+  BOOST_CHECK(teams[0] + teams[1] <= 4 || std::min(teams[0], teams[1]) == 1);
+  BOOST_CHECK(budget::instance()->get_running_kernels() == 0);
+  BOOST_CHECK(budget::instance()->get_threads_in_use() == 0);
+
+  // A host task running concurrently leaves the whole budget to a kernel
+  std::atomic<bool> host_running { false };
+  std::atomic<bool> kernel_done { false };
+  std::size_t team = 0;
+  q.submit([&] (handler &cgh) {
+      cgh.host_task([&] {
+          host_running = true;
+          for (auto deadline = std::chrono::steady_clock::now() + 10s;
+               !kernel_done && std::chrono::steady_clock::now() < deadline;)
+            std::this_thread::yield();
+        });
+    });
+  q.submit([&] (handler &cgh) {
+      cgh.single_task([&] {
+          for (auto deadline = std::chrono::steady_clock::now() + 10s;
+               !host_running && std::chrono::steady_clock::now() < deadline;)
+            std::this_thread::yield();
+          team = budget::team_size();
+          kernel_done = true;
+        });
+    });
+  q.wait();
+  BOOST_CHECK(host_running);
+  BOOST_CHECK(team == 4);
+
+  // A parallel_for stays within the budget of its kernel
+  buffer<int> a { N };
+  std::atomic<std::size_t> max_threads { 0 };
+  q.submit([&] (handler &cgh) {
+      auto ka = a.get_access<access::mode::discard_write>(cgh);
+      cgh.parallel_for(range<1> { N }, [=, &max_threads] (id<1> i) {
+          ka[i] = i[0];
+#ifdef _OPENMP
+          std::size_t threads = omp_get_num_threads();
+          auto seen = max_threads.load();
+          while (threads > seen
+                 && !max_threads.compare_exchange_weak(seen, threads));
+#endif
+        });
+    });
+  auto aa = a.get_access<access::mode::read>();
+  for (size_t i = 0; i < N; ++i)
+    BOOST_CHECK(aa[i] == static_cast<int>(i));
+  BOOST_CHECK(max_threads <= 4);
+
+  return 0;
+}
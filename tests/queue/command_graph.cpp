@@ -0,0 +1,112 @@
+/* RUN: %{execute}%s
+
+   Record a Jacobi-like iteration with a diamond of dependencies into a
+   command_graph and replay it many times
+*/
+#include <CL/sycl.hpp>
+
+#include <boost/test/minimal.hpp>
+
+using namespace cl::sycl;
+
+constexpr size_t N = 16;
+constexpr int iterations = 100;
+
+int test_main(int argc, char *argv[]) {
+  buffer<int> a { N };
+  buffer<int> b { N };
+  buffer<int> c { N };
+  {
+    queue q;
+    q.submit([&] (handler &cgh) {
+        auto ka = a.get_access<access::mode::discard_write>(cgh);
+        cgh.parallel_for(range<1> { N }, [=] (id<1> i) { ka[i] = i[0]; });
+      });
+
+    command_graph g;
+    q.begin_recording(g);
+    // 2 independent readers of a
+    q.submit([&] (handler &cgh) {
+        auto ka = a.get_access<access::mode::read>(cgh);
+        auto kb = b.get_access<access::mode::discard_write>(cgh);
+        cgh.parallel_for(range<1> { N }, [=] (id<1> i) { kb[i] = ka[i] + 1; });
+      });
+    q.submit([&] (handler &cgh) {
+        auto ka = a.get_access<access::mode::read>(cgh);
+        auto kc = c.get_access<access::mode::discard_write>(cgh);
+        cgh.parallel_for(range<1> { N }, [=] (id<1> i) { kc[i] = ka[i] - 1; });
+      });
+    // Then a writer of a waiting for both of them
+    auto writer = q.submit([&] (handler &cgh) {
+        auto ka = a.get_access<access::mode::discard_write>(cgh);
+        auto kb = b.get_access<access::mode::read>(cgh);
+        auto kc = c.get_access<access::mode::read>(cgh);
+        cgh.parallel_for(range<1> { N }, [=] (id<1> i) {
+            ka[i] = (kb[i] + kc[i])/2 + 1;
+          });
+      });
+    q.end_recording();
+    BOOST_CHECK(g.size() == 3);
+
+    // A recorded command group is never executed by itself
+    bool thrown = false;
+    try {
+      writer.wait();
+    } catch (const invalid_object_error &) {
+      thrown = true;
+    }
+    BOOST_CHECK(thrown);
+    thrown = false;
+    try {
+      q.submit([&] (handler &cgh) {
+          cgh.depends_on(writer);
+          cgh.single_task([] {});
+        });
+    } catch (const invalid_object_error &) {
+      thrown = true;
+    }
+    BOOST_CHECK(thrown);
+
+    // Nothing has been executed while recording
+    {
+      auto aa = a.get_access<access::mode::read>();
+      for (size_t i = 0; i < N; ++i)
+        BOOST_CHECK(aa[i] == static_cast<int>(i));
+    }
+
+    for (int i = 0; i < iterations; ++i)
+      q.replay(g);
+    // A normal submission after the replays still sees their effects
+    q.submit([&] (handler &cgh) {
+        auto ka = a.get_access<access::mode::read_write>(cgh);
+        cgh.parallel_for(range<1> { N }, [=] (id<1> i) { ka[i] *= 2; });
+      });
+    q.wait();
+  }
+
+  // A replayed kernel gets the same share of the budget as a normal one
+  {
+    using budget = ::trisycl::detail::thread_budget;
+    queue q { property_list { property::queue::thread_budget { 8 } } };
+    buffer<std::size_t> team { 2 };
+    auto record_team = [&] (handler &cgh, int i) {
+      auto t = team.get_access<access::mode::write>(cgh);
+      cgh.single_task([=] { t[i] = budget::team_size(); });
+    };
+    q.submit([&] (handler &cgh) { record_team(cgh, 0); });
+    command_graph g;
+    q.begin_recording(g);
+    q.submit([&] (handler &cgh) { record_team(cgh, 1); });
+    q.end_recording();
+    q.replay(g);
+    q.wait();
+    auto t = team.get_access<access::mode::read>();
+    BOOST_CHECK(t[0] == 8);
+    BOOST_CHECK(t[1] == 8);
+  }
+  auto aa = a.get_access<access::mode::read>();
+  for (size_t i = 0; i < N; ++i)
+    BOOST_CHECK(aa[i] == 2*static_cast<int>(i + iterations));
+
+  return 0;
+}
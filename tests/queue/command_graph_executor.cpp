@@ -0,0 +1,57 @@
+/* RUN: %{execute}%s
+
+   Test that replaying a command_graph with independent command groups
+   does not block a worker of the executor while waiting for them
+*/
+#include <CL/sycl.hpp>
+
+#include <boost/test/minimal.hpp>
+
+using namespace cl::sycl;
+
+constexpr size_t N = 16;
+constexpr int iterations = 100;
+
+int test_main(int argc, char *argv[]) {
+  buffer<int> a { N };
+  buffer<int> b { N };
+  {
+    // With a single worker, a blocked replay would need another one
+    queue q { property_list { property::queue::executor_concurrency { 1 } } };
+    q.submit([&] (handler &cgh) {
+        auto ka = a.get_access<access::mode::discard_write>(cgh);
+        auto kb = b.get_access<access::mode::discard_write>(cgh);
+        cgh.parallel_for(range<1> { N }, [=] (id<1> i) {
+            ka[i] = 0;
+            kb[i] = 0;
+          });
+      });
+
+    command_graph g;
+    q.begin_recording(g);
+    // 2 independent command groups, run concurrently by each replay
+    q.submit([&] (handler &cgh) {
+        auto ka = a.get_access<access::mode::read_write>(cgh);
+        cgh.parallel_for(range<1> { N }, [=] (id<1> i) { ++ka[i]; });
+      });
+    q.submit([&] (handler &cgh) {
+        auto kb = b.get_access<access::mode::read_write>(cgh);
+        cgh.parallel_for(range<1> { N }, [=] (id<1> i) { kb[i] += 2; });
+      });
+    q.end_recording();
+
+    for (int i = 0; i < iterations; ++i)
+      q.replay(g);
+    q.wait();
+    BOOST_CHECK(::trisycl::detail::executor::instance()->get_worker_count()
+                == 1);
+  }
+  auto aa = a.get_access<access::mode::read>();
+  auto ab = b.get_access<access::mode::read>();
+  for (size_t i = 0; i < N; ++i) {
+    BOOST_CHECK(aa[i] == iterations);
+    BOOST_CHECK(ab[i] == 2*iterations);
+  }
+
+  return 0;
+}
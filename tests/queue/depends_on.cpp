@@ -0,0 +1,81 @@
+/* RUN: %{execute}%s
+
+   Test the explicit dependencies between command groups which do not
+   share any buffer
+*/
+#include <CL/sycl.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+#include <boost/test/minimal.hpp>
+
+using namespace cl::sycl;
+using namespace std::chrono_literals;
+
+int test_main(int argc, char *argv[]) {
+  queue q;
+  std::atomic<int> stage { 0 };
+  std::atomic<bool> in_order { true };
+
+  auto first = q.submit([&] (handler &cgh) {
+      cgh.single_task([&] {
+          // Let the others run too early if they do not wait
+          std::this_thread::sleep_for(50ms);
+          stage = 1;
+        });
+    });
+  auto second = q.submit([&] (handler &cgh) {
+      cgh.depends_on(first);
+      cgh.single_task([&] {
+          if (stage != 1)
+            in_order = false;
+          std::this_thread::sleep_for(50ms);
+          stage = 2;
+        });
+    });
+  auto third = q.submit([&] (handler &cgh) {
+      cgh.single_task([&] {
+          std::this_thread::sleep_for(20ms);
+        });
+    });
+  q.submit([&] (handler &cgh) {
+      cgh.depends_on({ second, third, event {} });
+      cgh.single_task([&] {
+          if (stage != 2)
+            in_order = false;
+          stage = 3;
+        });
+    });
+  q.wait();
+  BOOST_CHECK(in_order);
+  BOOST_CHECK(stage == 3);
+
+  // The explicit dependencies are kept by the recorded command groups
+  command_graph g;
+  q.begin_recording(g);
+  auto produce = q.submit([&] (handler &cgh) {
+      cgh.single_task([&] {
+          std::this_thread::sleep_for(20ms);
+          ++stage;
+        });
+    });
+  q.submit([&] (handler &cgh) {
+      cgh.depends_on(produce);
+      cgh.single_task([&] {
+          // The producer has just made the stage even
+          if (stage % 2 == 0)
+            ++stage;
+          else
+            in_order = false;
+        });
+    });
+  q.end_recording();
+  for (int i = 0; i < 3; ++i)
+    q.replay(g).wait();
+  BOOST_CHECK(in_order);
+  BOOST_CHECK(stage == 9);
+
+  return 0;
+}
@@ -0,0 +1,51 @@
+/* RUN: %{execute}%s
+
+   Test that a lot of small dependent and independent kernels run on
+   the persistent host executor with a configured concurrency
+*/
+#include <CL/sycl.hpp>
+
+#include <boost/test/minimal.hpp>
+
+using namespace cl::sycl;
+
+constexpr size_t N = 16;
+constexpr int iterations = 1000;
+
+int test_main(int argc, char *argv[]) {
+  buffer<int> a { N };
+  buffer<int> b { N };
+  {
+    queue q { property_list { property::queue::executor_concurrency { 2 } } };
+    BOOST_CHECK(q.has_property<property::queue::executor_concurrency>());
+    BOOST_CHECK(::trisycl::detail::executor::instance()->get_concurrency()
+                == 2);
+
+    q.submit([&] (handler &cgh) {
+        auto ka = a.get_access<access::mode::discard_write>(cgh);
+        cgh.parallel_for(range<1> { N }, [=] (id<1> i) { ka[i] = 0; });
+      });
+    // A long chain of kernels depending on each other through a
+    for (int i = 0; i < iterations; ++i)
+      q.submit([&] (handler &cgh) {
+          auto ka = a.get_access<access::mode::read_write>(cgh);
+          cgh.parallel_for(range<1> { N }, [=] (id<1> i) { ++ka[i]; });
+        });
+    // Some independent kernels interleaved with the chain
+    for (int i = 0; i < iterations; ++i)
+      q.submit([&] (handler &cgh) {
+          cgh.single_task([=] {});
+        });
+    q.submit([&] (handler &cgh) {
+        auto ka = a.get_access<access::mode::read>(cgh);
+        auto kb = b.get_access<access::mode::discard_write>(cgh);
+        cgh.parallel_for(range<1> { N }, [=] (id<1> i) { kb[i] = 2*ka[i]; });
+      });
+    q.wait();
+  }
+  auto ab = b.get_access<access::mode::read>();
+  for (size_t i = 0; i < N; ++i)
+    BOOST_CHECK(ab[i] == 2*iterations);
+
+  return 0;
+}
@@ -0,0 +1,68 @@
+/* RUN: %{execute}%s
+
+   Test that the command groups of an in-order queue run in submission
+   order, even when they do not share any buffer, and that the command
+   groups of another queue still wait for them
+*/
+#include <CL/sycl.hpp>
+
+#include <atomic>
+
+#include <boost/test/minimal.hpp>
+
+using namespace cl::sycl;
+
+constexpr size_t N = 16;
+constexpr int iterations = 1000;
+
+int test_main(int argc, char *argv[]) {
+  buffer<int> a { N };
+  buffer<int> copy { N };
+  // Count the kernels seen out of order
+  std::atomic<int> next { 0 };
+  std::atomic<int> out_of_order { 0 };
+  {
+    queue q { property_list { property::queue::in_order {} } };
+    BOOST_CHECK(q.is_in_order());
+    BOOST_CHECK(!queue {}.is_in_order());
+
+    q.submit([&] (handler &cgh) {
+        auto ka = a.get_access<access::mode::discard_write>(cgh);
+        cgh.parallel_for(range<1> { N }, [=] (id<1> i) { ka[i] = 0; });
+      });
+    for (int i = 0; i < iterations; ++i) {
+      q.submit([&] (handler &cgh) {
+          cgh.single_task([=, &next, &out_of_order] {
+              if (next++ != 2*i)
+                ++out_of_order;
+            });
+        });
+      q.submit([&] (handler &cgh) {
+          auto ka = a.get_access<access::mode::read_write>(cgh);
+          cgh.parallel_for(range<1> { N }, [=, &next] (id<1> j) {
+              ++ka[j];
+              // Only one work-item counts the kernel
+              if (j[0] == 0)
+                ++next;
+            });
+        });
+    }
+    // Another queue sees the accesses of the in-order queue
+    queue { }.submit([&] (handler &cgh) {
+        auto ka = a.get_access<access::mode::read>(cgh);
+        auto kc = copy.get_access<access::mode::discard_write>(cgh);
+        cgh.parallel_for(range<1> { N }, [=] (id<1> i) { kc[i] = ka[i]; });
+      });
+    q.wait();
+  }
+  BOOST_CHECK(out_of_order == 0);
+  BOOST_CHECK(next == 2*iterations);
+  auto aa = a.get_access<access::mode::read>();
+  for (size_t i = 0; i < N; ++i)
+    BOOST_CHECK(aa[i] == iterations);
+  auto ac = copy.get_access<access::mode::read>();
+  for (size_t i = 0; i < N; ++i)
+    BOOST_CHECK(ac[i] == iterations);
+
+  return 0;
+}
@@ -0,0 +1,83 @@
+/* RUN: %{execute}%s
+
+   Test the events returned by queue::submit to wait for a single
+   kernel and to get its profiling time stamps
+*/
+#include <CL/sycl.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+#include <boost/test/minimal.hpp>
+
+using namespace cl::sycl;
+
+constexpr size_t N = 16;
+
+int test_main(int argc, char *argv[]) {
+  buffer<int> a { N };
+  queue q { property_list { property::queue::enable_profiling {} } };
+  std::atomic<bool> go { false };
+
+  auto produce = q.submit([&] (handler &cgh) {
+      auto ka = a.get_access<access::mode::discard_write>(cgh);
+      cgh.parallel_for(range<1> { N }, [=] (id<1> i) { ka[i] = i[0]; });
+    });
+  auto consume = q.submit([&] (handler &cgh) {
+      auto ka = a.get_access<access::mode::read_write>(cgh);
+      cgh.single_task([=, &go] {
+          while (!go)
+            std::this_thread::yield();
+          for (size_t i = 0; i < N; ++i)
+            ka[i] *= 2;
+        });
+    });
+  // An independent kernel can be waited for on its own
+  auto independent = q.submit([&] (handler &cgh) {
+      cgh.single_task([=] {});
+    });
+  independent.wait();
+  BOOST_CHECK(independent.get_info<info::event::command_execution_status>()
+              == info::event_command_status::complete);
+  produce.wait();
+  BOOST_CHECK(consume.get_info<info::event::command_execution_status>()
+              != info::event_command_status::complete);
+
+  // The consumer directly waits for the producer
+  auto wait_list = consume.get_wait_list();
+  BOOST_CHECK(wait_list.size() == 1 && wait_list[0] == produce);
+  BOOST_CHECK(independent.get_wait_list().empty());
+
+  go = true;
+  event::wait({ produce, consume });
+  BOOST_CHECK(consume.get_info<info::event::command_execution_status>()
+              == info::event_command_status::complete);
+
+  using profiling = info::event_profiling;
+  auto submit = consume.get_profiling_info<profiling::command_submit>();
+  auto start = consume.get_profiling_info<profiling::command_start>();
+  auto end = consume.get_profiling_info<profiling::command_end>();
+  BOOST_CHECK(submit <= start && start <= end);
+  BOOST_CHECK(produce.get_profiling_info<profiling::command_end>() <= start);
+
+  // Without the property there is no profiling
+  queue nq;
+  auto e = nq.submit([&] (handler &cgh) {
+      cgh.single_task([=] {});
+    });
+  e.wait_and_throw();
+  bool thrown = false;
+  try {
+    e.get_profiling_info<profiling::command_start>();
+  } catch (const exception &) {
+    thrown = true;
+  }
+  BOOST_CHECK(thrown);
+
+  auto aa = a.get_access<access::mode::read>();
+  for (size_t i = 0; i < N; ++i)
+    BOOST_CHECK(aa[i] == 2*static_cast<int>(i));
+
+  return 0;
+}
@@ -0,0 +1,65 @@
+/* RUN: %{execute}%s
+
+   Test that a host task waits for the kernels producing its buffers
+   while an unrelated kernel runs concurrently
+*/
+#include <CL/sycl.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+#include <boost/test/minimal.hpp>
+
+using namespace cl::sycl;
+using namespace std::chrono_literals;
+
+constexpr size_t N = 16;
+
+int test_main(int argc, char *argv[]) {
+  buffer<int> a { N };
+  buffer<int> b { N };
+  std::atomic<bool> host_task_done { false };
+  std::atomic<bool> overlapped { false };
+  int sum = 0;
+  {
+    queue q;
+    q.submit([&] (handler &cgh) {
+        auto ka = a.get_access<access::mode::discard_write>(cgh);
+        cgh.parallel_for(range<1> { N }, [=] (id<1> i) { ka[i] = i[0]; });
+      });
+    // Some host code consuming a and producing b
+    q.submit([&] (handler &cgh) {
+        auto ka = a.get_access<access::mode::read>(cgh);
+        auto kb = b.get_access<access::mode::discard_write>(cgh);
+        cgh.host_task([=, &sum, &host_task_done] {
+            for (size_t i = 0; i < N; ++i) {
+              sum += ka[i];
+              kb[i] = 2*ka[i];
+            }
+            // Let the unrelated kernel run meanwhile
+            std::this_thread::sleep_for(100ms);
+            host_task_done = true;
+          });
+      });
+    // An unrelated kernel is not blocked by the host task
+    q.submit([&] (handler &cgh) {
+        cgh.single_task([&] {
+            overlapped = !host_task_done;
+          });
+      });
+    // A kernel consuming what the host task produced
+    q.submit([&] (handler &cgh) {
+        auto kb = b.get_access<access::mode::read_write>(cgh);
+        cgh.parallel_for(range<1> { N }, [=] (id<1> i) { ++kb[i]; });
+      });
+    q.wait();
+  }
+  BOOST_CHECK(overlapped);
+  BOOST_CHECK(sum == N*(N - 1)/2);
+  auto kb = b.get_access<access::mode::read>();
+  for (size_t i = 0; i < N; ++i)
+    BOOST_CHECK(kb[i] == 2*static_cast<int>(i) + 1);
+
+  return 0;
+}
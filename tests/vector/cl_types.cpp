@@ -157,7 +157,7 @@ auto equal = [] (auto const &v, auto const &verif) {
   GENERATE_TEST_TYPE((char,              char,   0));                       \
   GENERATE_TEST_TYPE((unsigned char,     uchar,  0));                       \
   GENERATE_TEST_TYPE((short,             short,  0));                       \
-  GENERATE_TEST_TYPE((short int,         ushort, 0));                       \
+  GENERATE_TEST_TYPE((unsigned short,    ushort, 0));                       \
   GENERATE_TEST_TYPE((int,               int,    0));                       \
   GENERATE_TEST_TYPE((unsigned int,      uint,   0));                       \
   GENERATE_TEST_TYPE((long,              long,   0));                       \